@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    Binary plugin state: an 8 byte header followed by one little endian float
+    per parameter, in the order of parameterIDs. Saving reads the parameter
+    atomics and restoring sets the parameters directly, so neither builds a
+    ValueTree or touches XML; the APVTS catches its tree up on its own timer.
+
+    Layout, all little endian:
+        uint32  magic       'LDRS'
+        uint16  version     changes only if the layout itself does
+        uint16  numValues   parameters that follow
+        float   values[numValues]
+
+    Parameters are only ever appended to parameterIDs, so a blob with fewer
+    values than the current build is still read: the ones it predates go
+    back to their defaults. Blobs from a newer build read the values this
+    one knows about.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class CompactState
+{
+public:
+    static constexpr juce::uint32 magic = 0x5352444c;  // "LDRS" as stored
+    static constexpr juce::uint16 currentVersion = 1;
+    static constexpr size_t headerSize = 8;
+
+    /** Binary layout order. Append only. */
+    static constexpr const char* parameterIDs[] = { "CUTOFF", "RESONANCE", "DRIVE", "TYPE", "QUALITY",
+                                                    "OVERSAMPLING", "OS_FILTER", "OFFLINE_OS", "BYPASS",
+                                                    "VOICES", "KEYTRACK", "VELOCITY",
+                                                    "SC_CUTOFF", "SC_RESONANCE",
+                                                    "MORPH", "MORPH_TARGET" };
+
+    static constexpr size_t numParameters = std::size (parameterIDs);
+
+    CompactState() = default;
+
+    /** Resolves the parameters once, like ParameterSnapshot; call from the processor's constructor. */
+    void attachTo (juce::AudioProcessorValueTreeState& apvts)
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            parameters[i] = apvts.getParameter (parameterIDs[i]);
+            values[i] = apvts.getRawParameterValue (parameterIDs[i]);
+            jassert (parameters[i] != nullptr && values[i] != nullptr);
+        }
+    }
+
+    /** True if the data starts with a binary state header, as opposed to JUCE's XML blob. */
+    static bool isCompactState (const void* data, int sizeInBytes) noexcept
+    {
+        return sizeInBytes >= (int) headerSize && juce::ByteOrder::littleEndianInt (data) == magic;
+    }
+
+    void write (juce::MemoryBlock& destData) const
+    {
+        destData.setSize (headerSize + numParameters * sizeof (float));
+        auto* out = static_cast<char*> (destData.getData());
+
+        writeLittleEndian (out, magic);
+        writeLittleEndian (out + 4, (juce::uint32) currentVersion | ((juce::uint32) numParameters << 16));
+
+        for (size_t i = 0; i < numParameters; ++i)
+            writeLittleEndian (out + headerSize + i * sizeof (float), values[i]->load (std::memory_order_relaxed));
+    }
+
+    /** Restores every parameter from a binary blob. Returns false, changing nothing,
+        if the data is not one or has a version this build can't read. */
+    bool read (const void* data, int sizeInBytes) const
+    {
+        if (! isCompactState (data, sizeInBytes))
+            return false;
+
+        const auto* in = static_cast<const char*> (data);
+        const auto version = juce::ByteOrder::littleEndianShort (in + 4);
+        const auto numValues = (size_t) juce::ByteOrder::littleEndianShort (in + 6);
+
+        if (version != currentVersion || (size_t) sizeInBytes < headerSize + numValues * sizeof (float))
+            return false;
+
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            const auto value = i < numValues ? readFloat (in + headerSize + i * sizeof (float)) : 0.0f;
+
+            if (i < numValues && std::isfinite (value))
+                parameters[i]->setValueNotifyingHost (parameters[i]->convertTo0to1 (value));
+            else
+                parameters[i]->setValueNotifyingHost (parameters[i]->getDefaultValue());
+        }
+
+        return true;
+    }
+
+private:
+    //==============================================================================
+    static void writeLittleEndian (char* dest, juce::uint32 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfBigEndian (value);
+        std::memcpy (dest, &value, sizeof (value));
+    }
+
+    static void writeLittleEndian (char* dest, float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        writeLittleEndian (dest, bits);
+    }
+
+    static float readFloat (const char* source) noexcept
+    {
+        const auto bits = juce::ByteOrder::littleEndianInt (source);
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    juce::RangedAudioParameter* parameters[numParameters] {};
+    std::atomic<float>* values[numParameters] {};
+
+    JUCE_DECLARE_NON_COPYABLE (CompactState)
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The one background thread the editor widgets do their heavy work on, shared
+    by every open editor through juce::SharedResourcePointer<EditorWorker>.
+*/
+struct EditorWorker  : public juce::TimeSliceThread
+{
+    EditorWorker() : juce::TimeSliceThread ("Ladder editor worker")
+    {
+        startThread (3); // below normal, above idle
+    }
+
+    ~EditorWorker() override
+    {
+        stopThread (1000);
+    }
+};
@@ -0,0 +1,1074 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Saturation.h"
+
+#include <complex>
+
+//==============================================================================
+/**
+    Project-owned version of juce::dsp::LadderFilter.
+
+    Uses the same topology, coefficient mapping and tanh saturation as the JUCE
+    ladder, but can keep the five state values of up to SIMDRegister::size()
+    channels interleaved in vector lanes, so several channels run through one
+    instruction stream. Mono (or builds without JUCE_USE_SIMD) runs the same
+    kernel on plain scalars. Channels are gathered into the lanes and scattered
+    back every sample, so the lanes only pay where enough arithmetic is shared:
+    the closed form saturation kernels gain from two channels up, but the lookup
+    table runs once per lane, so with it only three or more float channels are
+    vectorised (see chooseVectorised and ladder_bench --layouts). The state is
+    moved between the layouts in place when the kernel changes.
+
+    Unlike LadderFilter::setMode, a mode change does not reset the state: the
+    output taps are ramped from the old mode to the new one over a few
+    milliseconds, which crossfades the two responses without a click.
+
+    Coefficients are computed at a control rate (every 16 samples by default)
+    and linearly interpolated in between, so the exp() of the cutoff transform
+    runs once per control period instead of once per sample, and the per
+    sample coefficient work is shared by every channel group. Cutoff,
+    resonance and drive glide to new targets over setRampLength samples, so
+    the caller can spread a parameter change across the block it arrives in.
+
+    Each mode has its own compiled kernel with the output mix and feedback
+    compensation baked in, picked from a function pointer table whenever the
+    mode or saturation changes. The generic kernel, which mixes all five
+    stages through run-time taps, is only used while a mode change fades.
+
+    The input stage carries Saturation::denormalGuard, so the state never
+    decays into subnormals and the ladder costs the same per sample whether or
+    not the caller has flush-to-zero enabled.
+
+    Cutoff and resonance can also be modulated per sample (see setModulation),
+    e.g. from a sidechain. The modulated coefficients are worked out once per
+    sample for all channels and fed to the same kernels: a cutoff offset of x
+    octaves raises a1 to the power 2^x, which is evaluated as
+    2^(log2 (a1) * 2^x) with a branch free exp2 (fastExp2), so the loop over
+    the chunk vectorises instead of calling std::pow per sample. Constant
+    modulation is folded into the control-rate coefficients, so it costs
+    nothing per sample.
+*/
+template <typename SampleType>
+class LadderEngine
+{
+public:
+    using Mode = juce::dsp::LadderFilterMode;
+
+   #if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = Vec::SIMDNumElements;
+    static constexpr size_t laneAlignment = Vec::SIMDRegisterSize;
+   #else
+    static constexpr size_t numLanes = 1;
+    static constexpr size_t laneAlignment = alignof (SampleType);
+   #endif
+
+    LadderEngine()
+    {
+        setSampleRate (SampleType (1000));
+        setResonance (SampleType (0));
+        setDrive (SampleType (1.2));
+        taps = previousTaps = tapsForMode (mode);
+        updateProcessors();
+    }
+
+    //==============================================================================
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = (size_t) spec.numChannels;
+        maxBlockSize = juce::jmax ((size_t) 1, (size_t) spec.maximumBlockSize);
+
+        // Room for the vectorised layout, which is never smaller than the scalar one
+        const auto vectorisedGroups = (numChannels + numLanes - 1) / numLanes;
+        stateStorage.assign (vectorisedGroups * numLanes * numStates + numLanes, SampleType (0));
+        state = alignedPointer (stateStorage.data());
+        layoutScratch.assign (numChannels * numStates, SampleType (0));
+        useSimd = false;
+        numGroups = numChannels;
+
+        a1Values.assign (maxBlockSize, SampleType (0));
+        log2A1Values.assign (maxBlockSize, SampleType (0));
+        b0Values.assign (maxBlockSize, SampleType (0));
+        b1Values.assign (maxBlockSize, SampleType (0));
+        feedbackValues.assign (maxBlockSize, SampleType (0));
+        driveValues.assign (maxBlockSize, SampleType (0));
+        gainValues.assign (maxBlockSize, SampleType (0));
+        drive2Values.assign (maxBlockSize, SampleType (0));
+        gain2Values.assign (maxBlockSize, SampleType (0));
+        fadeValues.assign (maxBlockSize, SampleType (1));
+
+        inputPointers.assign (numChannels, nullptr);
+        outputPointers.assign (numChannels, nullptr);
+        updateProcessors();
+
+        setSampleRate (SampleType (spec.sampleRate));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill (stateStorage.begin(), stateStorage.end(), SampleType (0));
+        snapControlValues();
+        previousTaps = taps;
+        tapFadeRemaining = 0;
+    }
+
+    //==============================================================================
+    /** Changes the rate the ladder runs at without reallocating anything, e.g. when
+        an oversampling factor changes. The smoothers jump to their targets, and the
+        ramp length goes back to 50 ms. */
+    void setSampleRate (SampleType newValue) noexcept
+    {
+        jassert (newValue > SampleType (0));
+        cutoffFreqScaler = SampleType (-2.0 * juce::MathConstants<double>::pi) / newValue;
+        maxCutoff = juce::jmin (SampleType (20000), newValue * SampleType (0.45));
+        minLog2A1 = maxCutoff * cutoffFreqScaler * log2e;
+        maxLog2A1 = SampleType (20) * cutoffFreqScaler * log2e;
+
+        static constexpr SampleType smootherRampTimeSec = SampleType (0.05);
+        cutoffSmoother.reset (newValue, smootherRampTimeSec);
+        scaledResonanceSmoother.reset (newValue, smootherRampTimeSec);
+        driveSmoother.reset (newValue, smootherRampTimeSec);
+        rampLength = juce::roundToInt (newValue * smootherRampTimeSec);
+
+        tapFadeLength = juce::jmax (1, juce::roundToInt (newValue * SampleType (tapFadeSeconds)));
+        tapFadeRemaining = juce::jmin (tapFadeRemaining, tapFadeLength);
+
+        snapControlValues();
+    }
+
+    /** Sets how many samples apart the coefficients are computed; they are linearly
+        interpolated in between. 1 recomputes them every sample. */
+    void setControlInterval (int numSamples) noexcept
+    {
+        controlInterval = juce::jmax (1, numSamples);
+        restartControlPeriod();
+    }
+
+    /** How many samples the cutoff, resonance and drive take to reach a new target.
+        A glide already under way is not restarted: it carries on from where the
+        audio is and covers what is left of it in the new length. */
+    void setRampLength (int numSamples) noexcept
+    {
+        numSamples = juce::jmax (1, numSamples);
+
+        if (numSamples == rampLength)
+            return;
+
+        rampLength = numSamples;
+        restartControlPeriod();
+        setRampSteps (cutoffSmoother, rampLength);
+        setRampSteps (scaledResonanceSmoother, rampLength);
+        setRampSteps (driveSmoother, rampLength);
+    }
+
+    /** Modulation for the next process() call only: per sample cutoff offsets in octaves and
+        resonance offsets, each covering the whole block, or nullptr for none. */
+    void setModulation (const SampleType* cutoffOctaves, const SampleType* resonanceOffsets) noexcept
+    {
+        cutoffModulation = cutoffOctaves;
+        resonanceModulation = resonanceOffsets;
+    }
+
+    /** Modulation that holds still, applied at the control rate until changed; a new
+        value glides in over one control period. */
+    void setModulation (SampleType cutoffOctaves, SampleType resonanceOffset) noexcept
+    {
+        const auto ratio = std::exp2 (cutoffOctaves);
+        const auto offset = resonanceOffset * feedbackPerResonance;
+
+        if (ratio == constantCutoffRatio && offset == constantFeedbackOffset)
+            return;
+
+        restartControlPeriod();
+        constantCutoffRatio = ratio;
+        constantFeedbackOffset = offset;
+        targetsStale = true;
+    }
+
+    /** Switches the output taps; the change is crossfaded instead of resetting the state. */
+    void setMode (Mode newMode) noexcept
+    {
+        if (newMode == mode)
+            return;
+
+        previousTaps = currentTaps();
+        taps = tapsForMode (newMode);
+        mode = newMode;
+        updateProcessors();
+        tapFadeRemaining = tapFadeLength;
+    }
+
+    void setCutoffFrequencyHz (SampleType newCutoff) noexcept
+    {
+        jassert (newCutoff > SampleType (0));
+        restartControlPeriod();
+        cutoffSmoother.setTargetValue (newCutoff);
+    }
+
+    void setResonance (SampleType newResonance) noexcept
+    {
+        jassert (newResonance >= SampleType (0) && newResonance <= SampleType (1));
+        resonance = newResonance;
+        restartControlPeriod();
+        scaledResonanceSmoother.setTargetValue (juce::jmap (resonance, SampleType (0.1), SampleType (1)));
+    }
+
+    void setDrive (SampleType newDrive) noexcept
+    {
+        jassert (newDrive >= SampleType (1));
+        restartControlPeriod();
+        driveSmoother.setTargetValue (newDrive);
+    }
+
+    /** Picks the tanh approximation used by both saturation stages, see Saturation.h. */
+    void setSaturation (Saturation::Kernel newKernel) noexcept
+    {
+        saturation = newKernel;
+        updateProcessors();
+    }
+
+    /** Switches between the per mode kernels and the generic one; only the benchmark turns them off. */
+    void setUseSpecialisedKernels (bool shouldUse) noexcept
+    {
+        useSpecialisedKernels = shouldUse;
+        updateProcessors();
+    }
+
+    /** How the channels are laid out. automatic picks the SIMD lanes only where they were
+        measured to pay (see chooseVectorised); the other two force a layout, so the
+        verification and the benchmark can compare them. */
+    enum class Layout
+    {
+        automatic,
+        scalar,
+        vectorised
+    };
+
+    void setLayout (Layout newLayout) noexcept
+    {
+        layout = newLayout;
+        updateProcessors();
+    }
+
+    Mode getMode() const noexcept           { return mode; }
+    bool isVectorised() const noexcept      { return useSimd; }
+    size_t getNumChannels() const noexcept  { return numChannels; }
+
+    /** Counts every recomputation of the cutoff transform, i.e. every control period that moved.
+        Returned by reference so a scoped timer can read it when the block ends. */
+    const juce::uint64& getCoefficientUpdateCounter() const noexcept  { return coefficientUpdates; }
+
+    /** True once every stage of every channel has rung out below the threshold. */
+    bool hasDecayed (SampleType threshold) const noexcept
+    {
+        return std::all_of (stateStorage.begin(), stateStorage.end(),
+                            [threshold] (SampleType v) { return std::abs (v) <= threshold; });
+    }
+
+    /** How long the ladder rings after its input stops, until it has decayed by decayDb.
+
+        Linearised around zero the loop is four one-pole stages (b0 + b1 z^-1) / (1 - a1 z^-1)
+        with the feedback gain K = 4 * resonance * drive2 * gain2 around them, so its poles are
+        the roots of z (z - a1)^4 + K (b0 z + b1)^4. The slowest one sets the decay.
+    */
+    static double getTailLengthSamples (double cutoffHz, double newResonance, double newDrive,
+                                        double sampleRate, double decayDb = -100.0) noexcept
+    {
+        const auto a1 = std::exp (-2.0 * juce::MathConstants<double>::pi * cutoffHz / sampleRate);
+        const auto g  = 1.0 - a1;
+        const auto b0 = g * 0.76923076923;
+        const auto b1 = g * 0.23076923076;
+
+        const auto drive2 = newDrive * 0.04 + 0.96;
+        const auto gain2  = std::pow (drive2, -2.642) * 0.6103 + 0.3903;
+        const auto k = 4.0 * juce::jmap (newResonance, 0.1, 1.0) * drive2 * gain2;
+
+        // Monic coefficients, c[i] multiplies z^i
+        const double c[5] = { k * std::pow (b1, 4.0),
+                              std::pow (a1, 4.0) + 4.0 * k * b0 * std::pow (b1, 3.0),
+                              -4.0 * std::pow (a1, 3.0) + 6.0 * k * b0 * b0 * b1 * b1,
+                              6.0 * a1 * a1 + 4.0 * k * std::pow (b0, 3.0) * b1,
+                              -4.0 * a1 + k * std::pow (b0, 4.0) };
+
+        const auto evaluate = [&c] (std::complex<double> z)
+        {
+            return (((((z + c[4]) * z + c[3]) * z + c[2]) * z + c[1]) * z + c[0]);
+        };
+
+        // Durand-Kerner, all five roots at once
+        std::complex<double> roots[5];
+        const std::complex<double> seed (0.4, 0.9);
+
+        for (int i = 0; i < 5; ++i)
+            roots[i] = std::pow (seed, i);
+
+        for (int iteration = 0; iteration < 200; ++iteration)
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                std::complex<double> denominator (1.0);
+
+                for (int j = 0; j < 5; ++j)
+                    if (j != i)
+                        denominator *= roots[i] - roots[j];
+
+                roots[i] -= evaluate (roots[i]) / denominator;
+            }
+        }
+
+        double radius = 0.0;
+
+        for (auto& r : roots)
+            radius = juce::jmax (radius, std::abs (r));
+
+        static constexpr double maxTailSeconds = 30.0;
+
+        if (radius >= 1.0)
+            return maxTailSeconds * sampleRate;
+
+        return juce::jmin (maxTailSeconds * sampleRate, decayDb / (20.0 * std::log10 (radius)));
+    }
+
+    /** Magnitude response of the linearised ladder (see getTailLengthSamples) at frequencyHz, for display. */
+    static double getMagnitudeResponse (Mode m, double cutoffHz, double newResonance, double newDrive,
+                                        double sampleRate, double frequencyHz) noexcept
+    {
+        const auto a1 = std::exp (-2.0 * juce::MathConstants<double>::pi * cutoffHz / sampleRate);
+        const auto g  = 1.0 - a1;
+        const auto b0 = g * 0.76923076923;
+        const auto b1 = g * 0.23076923076;
+
+        const auto inputGain = newDrive * (std::pow (newDrive, -2.642) * 0.6103 + 0.3903);
+        const auto drive2 = newDrive * 0.04 + 0.96;
+        const auto gain2  = std::pow (drive2, -2.642) * 0.6103 + 0.3903;
+        const auto k = 4.0 * juce::jmap (newResonance, 0.1, 1.0);
+
+        const auto t = tapsForMode (m);
+        const auto zInv = std::polar (1.0, -2.0 * juce::MathConstants<double>::pi * frequencyHz / sampleRate);
+        const auto stage = (b0 + b1 * zInv) / (1.0 - a1 * zInv);
+
+        // First stage input, then each stage output weighted by the mode's taps
+        const auto input = inputGain * (1.0 + k * (double) t.comp) / (1.0 + k * drive2 * gain2 * zInv * std::pow (stage, 4));
+
+        std::complex<double> mix, h (1.0);
+
+        for (size_t i = 0; i < numStates; ++i)
+        {
+            mix += (double) t.a[i] * h;
+            h *= stage;
+        }
+
+        return std::abs (input * mix);
+    }
+
+    //==============================================================================
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numSamples  = outputBlock.getNumSamples();
+
+        jassert (inputBlock.getNumChannels() == outputBlock.getNumChannels());
+        jassert (outputBlock.getNumChannels() <= numChannels);
+
+        if (context.isBypassed)
+        {
+            outputBlock.copyFrom (inputBlock);
+            return;
+        }
+
+        for (size_t start = 0; start < numSamples; start += maxBlockSize)
+        {
+            const auto length = juce::jmin (maxBlockSize, numSamples - start);
+            const auto fading = fillControlValues (length);
+
+            if (cutoffModulation != nullptr || resonanceModulation != nullptr)
+                applyModulation (start, length);
+
+            processChunk (inputBlock.getSubBlock (start, length),
+                          outputBlock.getSubBlock (start, length),
+                          fading);
+        }
+
+        cutoffModulation = resonanceModulation = nullptr;
+    }
+
+private:
+    //==============================================================================
+    static constexpr size_t numStates = 5;
+    static constexpr SampleType outputGain = SampleType (1.2);
+    static constexpr double tapFadeSeconds = 0.01;
+    static constexpr SampleType feedbackPerResonance = SampleType (-4 * 0.9);  // d(feedback) / d(resonance)
+    static constexpr SampleType log2e = SampleType (1.44269504088896340736);
+
+    /** Output mix of the five stages plus the feedback compensation for one mode. */
+    struct Taps
+    {
+        SampleType a[numStates];
+        SampleType comp;
+    };
+
+    static Taps tapsForMode (Mode m) noexcept
+    {
+        Taps t {};
+
+        switch (m)
+        {
+            case Mode::LPF12:   t = { { 0, 0,  1,  0, 0 }, SampleType (0.5) }; break;
+            case Mode::HPF12:   t = { { 1, -2, 1,  0, 0 }, SampleType (0) };   break;
+            case Mode::BPF12:   t = { { 0, 0, -1,  1, 0 }, SampleType (0.5) }; break;
+            case Mode::LPF24:   t = { { 0, 0,  0,  0, 1 }, SampleType (0.5) }; break;
+            case Mode::HPF24:   t = { { 1, -4, 6, -4, 1 }, SampleType (0) };   break;
+            case Mode::BPF24:   t = { { 0, 0,  1, -2, 1 }, SampleType (0.5) }; break;
+            default:            jassertfalse; break;
+        }
+
+        for (auto& a : t.a)
+            a *= outputGain;
+
+        return t;
+    }
+
+    /** The taps as heard right now, part way through a fade if one is running. */
+    Taps currentTaps() const noexcept
+    {
+        if (tapFadeRemaining <= 0)
+            return taps;
+
+        const auto amount = SampleType (1) - (SampleType) tapFadeRemaining / (SampleType) tapFadeLength;
+        Taps t;
+
+        for (size_t i = 0; i < numStates; ++i)
+            t.a[i] = previousTaps.a[i] + (taps.a[i] - previousTaps.a[i]) * amount;
+
+        t.comp = previousTaps.comp + (taps.comp - previousTaps.comp) * amount;
+        return t;
+    }
+
+    /** The input and feedback saturation settings for one drive value. */
+    struct DriveGains
+    {
+        SampleType drive, gain, drive2, gain2;
+    };
+
+    static DriveGains driveGainsFor (SampleType newDrive) noexcept
+    {
+        const auto drive2 = newDrive * SampleType (0.04) + SampleType (0.96);
+
+        return { newDrive, std::pow (newDrive, SampleType (-2.642)) * SampleType (0.6103) + SampleType (0.3903),
+                 drive2,   std::pow (drive2,   SampleType (-2.642)) * SampleType (0.6103) + SampleType (0.3903) };
+    }
+
+    /** Gives a smoother a new ramp length; reset() would jump it to its target, so the value is put back. */
+    template <typename Smoother>
+    static void setRampSteps (Smoother& smoother, int numSteps) noexcept
+    {
+        const auto current = smoother.getCurrentValue();
+        const auto target = smoother.getTargetValue();
+
+        smoother.reset (numSteps);
+        smoother.setCurrentAndTargetValue (current);
+        smoother.setTargetValue (target);
+    }
+
+    //==============================================================================
+    SampleType cutoffTransform (SampleType cutoffHz) const noexcept
+    {
+        return std::exp (cutoffHz * cutoffFreqScaler);
+    }
+
+    /** Jumps the smoothers and the interpolated coefficients to their targets. */
+    void snapControlValues() noexcept
+    {
+        cutoffSmoother.setCurrentAndTargetValue (cutoffSmoother.getTargetValue());
+        scaledResonanceSmoother.setCurrentAndTargetValue (scaledResonanceSmoother.getTargetValue());
+        driveSmoother.setCurrentAndTargetValue (driveSmoother.getTargetValue());
+
+        setTargets (cutoffSmoother.getTargetValue(), scaledResonanceSmoother.getTargetValue());
+        a1Value = a1Target;
+        log2A1Value = log2A1Target;
+        feedbackValue = feedbackTarget;
+        driveValue = driveTarget = driveGainsFor (driveSmoother.getTargetValue());
+        a1Step = log2A1Step = feedbackStep = SampleType (0);
+        driveStep = {};
+        controlCountdown = samplesSinceControlPoint = 0;
+    }
+
+    /** Brings the smoothers up to the last rendered sample. */
+    void syncSmoothers() noexcept
+    {
+        cutoffSmoother.skip (samplesSinceControlPoint);
+        scaledResonanceSmoother.skip (samplesSinceControlPoint);
+        driveSmoother.skip (samplesSinceControlPoint);
+        samplesSinceControlPoint = 0;
+    }
+
+    /** Makes a new target take effect on the next sample instead of at the end of the current period. */
+    void restartControlPeriod() noexcept
+    {
+        syncSmoothers();
+        a1Target = a1Value;
+        log2A1Target = log2A1Value;
+        feedbackTarget = feedbackValue;
+        driveTarget = driveValue;
+        controlCountdown = 0;
+    }
+
+    /** Computes the coefficients at the end of the next control period and the per sample steps towards them.
+        The smoothers themselves only advance as samples are rendered, so a new target set part way through
+        a period ramps from where the audio actually is. */
+    void startControlPeriod() noexcept
+    {
+        syncSmoothers();
+        a1Value = a1Target;
+        log2A1Value = log2A1Target;
+        feedbackValue = feedbackTarget;
+        driveValue = driveTarget;
+
+        auto cutoffAhead = cutoffSmoother;
+        auto resonanceAhead = scaledResonanceSmoother;
+        setTargets (cutoffAhead.skip (controlInterval), resonanceAhead.skip (controlInterval));
+        targetsStale = false;
+
+        const auto scale = SampleType (1) / (SampleType) controlInterval;
+        a1Step = (a1Target - a1Value) * scale;
+        log2A1Step = (log2A1Target - log2A1Value) * scale;
+        feedbackStep = (feedbackTarget - feedbackValue) * scale;
+
+        // The pow() calls only run while the drive glides
+        if (driveSmoother.isSmoothing())
+        {
+            auto driveAhead = driveSmoother;
+            driveTarget = driveGainsFor (driveAhead.skip (controlInterval));
+        }
+
+        driveStep = { (driveTarget.drive  - driveValue.drive)  * scale, (driveTarget.gain  - driveValue.gain)  * scale,
+                      (driveTarget.drive2 - driveValue.drive2) * scale, (driveTarget.gain2 - driveValue.gain2) * scale };
+
+        controlCountdown = controlInterval;
+        ++coefficientUpdates;
+    }
+
+    bool isSettled() const noexcept
+    {
+        return ! targetsStale && a1Step == SampleType (0) && feedbackStep == SampleType (0) && driveStep.drive == SampleType (0)
+            && ! cutoffSmoother.isSmoothing() && ! scaledResonanceSmoother.isSmoothing() && ! driveSmoother.isSmoothing();
+    }
+
+    /** Advances the coefficients and the tap fade for one chunk; returns true while fading. */
+    bool fillControlValues (size_t length) noexcept
+    {
+        driveMoving = driveStep.drive != SampleType (0) || driveSmoother.isSmoothing();
+
+        for (size_t n = 0; n < length; ++n)
+        {
+            if (controlCountdown == 0)
+            {
+                if (isSettled())
+                {
+                    // Nothing is moving: the rest of the chunk uses the same coefficients
+                    fillCoefficients (n, length, a1Value, log2A1Value, feedbackValue, driveValue);
+                    break;
+                }
+
+                startControlPeriod();
+            }
+
+            --controlCountdown;
+            ++samplesSinceControlPoint;
+            a1Value += a1Step;
+            log2A1Value += log2A1Step;
+            feedbackValue += feedbackStep;
+            driveValue.drive  += driveStep.drive;
+            driveValue.gain   += driveStep.gain;
+            driveValue.drive2 += driveStep.drive2;
+            driveValue.gain2  += driveStep.gain2;
+            fillCoefficients (n, n + 1, a1Value, log2A1Value, feedbackValue, driveValue);
+        }
+
+        if (tapFadeRemaining <= 0)
+            return false;
+
+        const auto step = SampleType (1) / (SampleType) tapFadeLength;
+
+        for (size_t n = 0; n < length; ++n)
+        {
+            tapFadeRemaining = juce::jmax (0, tapFadeRemaining - 1);
+            fadeValues[n] = SampleType (1) - (SampleType) tapFadeRemaining * step;
+        }
+
+        return true;
+    }
+
+    /** The coefficients at the end of a control period, for a smoothed cutoff and scaled resonance,
+        with the constant modulation folded in. */
+    void setTargets (SampleType cutoffHz, SampleType scaledResonance) noexcept
+    {
+        auto cutoff = cutoffHz;
+        auto feedback = scaledResonance * SampleType (-4);
+
+        if (constantCutoffRatio != SampleType (1) || constantFeedbackOffset != SampleType (0))
+        {
+            cutoff = juce::jlimit (SampleType (20), maxCutoff, cutoff * constantCutoffRatio);
+            feedback = modulateFeedback (feedback, constantFeedbackOffset);
+        }
+
+        a1Target = cutoffTransform (cutoff);
+        log2A1Target = cutoff * cutoffFreqScaler * log2e;
+        feedbackTarget = feedback;
+    }
+
+    void fillCoefficients (size_t start, size_t end, SampleType a1, SampleType log2A1,
+                           SampleType feedback, const DriveGains& d) noexcept
+    {
+        const auto g  = SampleType (1) - a1;
+        const auto b0 = g * SampleType (0.76923076923);
+        const auto b1 = g * SampleType (0.23076923076);
+
+        for (auto n = start; n < end; ++n)
+        {
+            a1Values[n] = a1;
+            log2A1Values[n] = log2A1;
+            b0Values[n] = b0;
+            b1Values[n] = b1;
+            feedbackValues[n] = feedback;
+            driveValues[n] = d.drive;
+            gainValues[n] = d.gain;
+            drive2Values[n] = d.drive2;
+            gain2Values[n] = d.gain2;
+        }
+    }
+
+    /** 2^x for |x| < 100, branch free so the per sample loops around it vectorise. The integer
+        part goes straight into the exponent bits and the fraction through a polynomial, good to
+        about 1e-9 relative, below float's own precision. Relies on strict IEEE rounding, which
+        the builds keep (no fast-math). */
+    static SampleType fastExp2 (SampleType x) noexcept
+    {
+        using Bits = std::conditional_t<std::is_same_v<SampleType, float>, juce::uint32, juce::uint64>;
+        constexpr auto mantissaBits = std::numeric_limits<SampleType>::digits - 1;
+        constexpr auto exponentBias = (Bits) (std::numeric_limits<SampleType>::max_exponent - 1);
+
+        // Adding 1.5 * 2^mantissaBits rounds to an integer, which lands in the low bits
+        constexpr auto shifter = SampleType (1.5) * (SampleType) ((Bits) 1 << mantissaBits);
+
+        x = clampSmooth (x, SampleType (-100), SampleType (100));
+        const auto shifted = x + shifter;
+        const auto t = (x - (shifted - shifter)) * SampleType (0.69314718055994530942);
+
+        Bits bits, shifterBits;
+        std::memcpy (&bits, &shifted, sizeof (bits));
+        std::memcpy (&shifterBits, &shifter, sizeof (shifterBits));
+
+        const Bits scaleBits = (bits - shifterBits + exponentBias) << mantissaBits;
+        SampleType scale;
+        std::memcpy (&scale, &scaleBits, sizeof (scale));
+
+        // e^t for |t| <= ln (2) / 2, Taylor series to the 7th power
+        const auto p = SampleType (1) + t * (SampleType (1) + t * (SampleType (1.0 / 2) + t * (SampleType (1.0 / 6)
+                     + t * (SampleType (1.0 / 24) + t * (SampleType (1.0 / 120) + t * (SampleType (1.0 / 720)
+                     + t * SampleType (1.0 / 5040)))))));
+        return p * scale;
+    }
+
+    /** jlimit without comparisons. GCC will not if-convert float compares while floating point
+        traps are honoured (the default), so a jlimit keeps its loop scalar; abs is a bit mask.
+        (a + |a|) / 2 is exactly max (a, 0), so values in range come back untouched and values
+        outside land within a rounding step of the limit. */
+    static SampleType clampSmooth (SampleType x, SampleType low, SampleType high) noexcept
+    {
+        const auto above = x - high;
+        x -= (above + std::abs (above)) * SampleType (0.5);
+        const auto below = low - x;
+        return x + (below + std::abs (below)) * SampleType (0.5);
+    }
+
+    static SampleType modulateFeedback (SampleType feedback, SampleType offset) noexcept
+    {
+        return clampSmooth (feedback + offset, SampleType (-4), SampleType (-0.4));
+    }
+
+    /** Rewrites the chunk's coefficient streams with the per sample modulation on top. */
+    void applyModulation (size_t offset, size_t length) noexcept
+    {
+        if (cutoffModulation != nullptr)
+        {
+            // Locals, or the stores below could alias the members and the loop stays scalar
+            const auto lowest = minLog2A1, highest = maxLog2A1;
+
+            for (size_t n = 0; n < length; ++n)
+            {
+                // a1^(2^x) = 2^(log2 (a1) * 2^x), on top of any constant modulation already in the stream
+                const auto log2A1 = clampSmooth (log2A1Values[n] * fastExp2 (cutoffModulation[offset + n]), lowest, highest);
+                const auto a1 = fastExp2 (log2A1);
+                const auto g = SampleType (1) - a1;
+
+                a1Values[n] = a1;
+                b0Values[n] = g * SampleType (0.76923076923);
+                b1Values[n] = g * SampleType (0.23076923076);
+            }
+        }
+
+        if (resonanceModulation != nullptr)
+            for (size_t n = 0; n < length; ++n)
+                feedbackValues[n] = modulateFeedback (feedbackValues[n], resonanceModulation[offset + n] * feedbackPerResonance);
+    }
+
+    template <typename InputBlock, typename OutputBlock>
+    void processChunk (const InputBlock& input, const OutputBlock& output, bool fading) noexcept
+    {
+        const auto numActive = output.getNumChannels();
+
+        for (size_t ch = 0; ch < numActive; ++ch)
+        {
+            inputPointers[ch]  = input.getChannelPointer (ch);
+            outputPointers[ch] = output.getChannelPointer (ch);
+        }
+
+        (this->*(fading ? fadingProcessor : steadyProcessor)) (numActive, output.getNumSamples());
+    }
+
+    //==============================================================================
+    /** What the kernel mixes into the output: run-time taps, or one mode fixed at compile time. */
+    enum class Topology
+    {
+        generic,
+        fading,
+        lpf12,
+        hpf12,
+        bpf12,
+        lpf24,
+        hpf24,
+        bpf24
+    };
+
+    static constexpr size_t numTopologies = 8;
+    static constexpr size_t numKernels = 3;
+
+    using GroupProcessor = void (LadderEngine::*) (size_t, size_t) noexcept;
+
+    static Topology topologyForMode (Mode m) noexcept
+    {
+        return (Topology) ((int) Topology::lpf12 + (int) m);
+    }
+
+    template <typename V, Saturation::Kernel kernel, size_t... topologies>
+    static constexpr std::array<GroupProcessor, numTopologies> makeProcessorRow (std::index_sequence<topologies...>) noexcept
+    {
+        return { { &LadderEngine::processGroups<V, kernel, (Topology) topologies>... } };
+    }
+
+    template <typename V>
+    static GroupProcessor lookupProcessor (Saturation::Kernel kernel, Topology topology) noexcept
+    {
+        using K = Saturation::Kernel;
+        constexpr auto topologies = std::make_index_sequence<numTopologies>();
+
+        static constexpr std::array<std::array<GroupProcessor, numTopologies>, numKernels> table { {
+            makeProcessorRow<V, K::lookupTable> (topologies),
+            makeProcessorRow<V, K::pade> (topologies),
+            makeProcessorRow<V, K::polynomial> (topologies)
+        } };
+
+        return table[(size_t) kernel][(size_t) topology];
+    }
+
+    /** Whether the channels should share SIMD lanes, from ladder_bench --layouts: with the
+        closed form kernels the lanes win from two channels up (about 1.3x for stereo, 2.5x
+        for four float channels). The lookup table is read once per lane, so in stereo the
+        gather and scatter cost more than the shared arithmetic saves; it wins from three
+        float channels, and never with the two lanes of a double register. */
+    bool chooseVectorised() const noexcept
+    {
+       #if JUCE_USE_SIMD
+        if (numChannels < 2 || layout == Layout::scalar)
+            return false;
+
+        if (layout == Layout::vectorised)
+            return true;
+
+        if (saturation == Saturation::Kernel::lookupTable)
+            return numLanes >= 4 && numChannels > 2;
+
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    /** Where a channel's stage lives in the current layout: group-major, then stage, then lane. */
+    size_t stateIndex (size_t channel, size_t stage) const noexcept
+    {
+        const auto lanes = useSimd ? numLanes : (size_t) 1;
+        return ((channel / lanes) * numStates + stage) * lanes + channel % lanes;
+    }
+
+    /** Moves the state to the other layout through the scratch copy, without allocating. */
+    void switchLayout (bool vectorised) noexcept
+    {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (size_t i = 0; i < numStates; ++i)
+                layoutScratch[ch * numStates + i] = state[stateIndex (ch, i)];
+
+        useSimd = vectorised;
+        const auto lanes = useSimd ? numLanes : (size_t) 1;
+        numGroups = (numChannels + lanes - 1) / lanes;
+
+        // Lanes past the last channel start from silence
+        std::fill (stateStorage.begin(), stateStorage.end(), SampleType (0));
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (size_t i = 0; i < numStates; ++i)
+                state[stateIndex (ch, i)] = layoutScratch[ch * numStates + i];
+    }
+
+    /** Re-picks the layout and the kernels after a mode, saturation or layout change. */
+    void updateProcessors() noexcept
+    {
+        if (chooseVectorised() != useSimd)
+            switchLayout (! useSimd);
+
+        const auto steady = useSpecialisedKernels ? topologyForMode (mode) : Topology::generic;
+
+       #if JUCE_USE_SIMD
+        if (useSimd)
+        {
+            steadyProcessor = lookupProcessor<Vec> (saturation, steady);
+            fadingProcessor = lookupProcessor<Vec> (saturation, Topology::fading);
+            return;
+        }
+       #endif
+
+        steadyProcessor = lookupProcessor<SampleType> (saturation, steady);
+        fadingProcessor = lookupProcessor<SampleType> (saturation, Topology::fading);
+    }
+
+    //==============================================================================
+    template <typename V>
+    static constexpr size_t lanesOf() noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            return 1;
+       #if JUCE_USE_SIMD
+        else
+            return numLanes;
+       #endif
+    }
+
+    template <typename V>
+    static V broadcast (SampleType value) noexcept
+    {
+        return Saturation::broadcast<SampleType, V> (value);
+    }
+
+    template <typename V, Saturation::Kernel kernel>
+    V saturate (V x) const noexcept
+    {
+        if constexpr (kernel == Saturation::Kernel::pade)
+            return Saturation::pade<SampleType> (x);
+        else if constexpr (kernel == Saturation::Kernel::polynomial)
+            return Saturation::polynomial<SampleType> (x);
+        else
+            return Saturation::perLane<SampleType> (x, [this] (SampleType v) { return saturationLUT (v); });
+    }
+
+    /** Runs every channel group through the ladder, one group of lanes at a time. */
+    template <typename V, Saturation::Kernel kernel, Topology topology>
+    void processGroups (size_t numActive, size_t numSamples) noexcept
+    {
+        constexpr auto lanes = lanesOf<V>();
+
+        // Separate frames, so the lanes past the last channel keep a silent input
+        alignas (laneAlignment) SampleType inFrame[lanes];
+        alignas (laneAlignment) SampleType outFrame[lanes];
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            const auto firstChannel = group * lanes;
+
+            if (firstChannel >= numActive)
+                break;
+
+            const auto groupChannels = juce::jmin (lanes, numActive - firstChannel);
+
+            const SampleType* in[lanes] {};
+            SampleType* out[lanes] {};
+
+            for (size_t lane = 0; lane < groupChannels; ++lane)
+            {
+                in[lane]  = inputPointers[firstChannel + lane];
+                out[lane] = outputPointers[firstChannel + lane];
+            }
+
+            auto* groupState = state + group * lanes * numStates;
+            V s[numStates];
+
+            for (size_t i = 0; i < numStates; ++i)
+                s[i] = load<V> (groupState + i * lanes);
+
+            std::fill (inFrame, inFrame + lanes, SampleType (0));
+
+            for (size_t n = 0; n < numSamples; ++n)
+            {
+                for (size_t lane = 0; lane < groupChannels; ++lane)
+                    inFrame[lane] = in[lane][n];
+
+                const auto y = tick<V, kernel, topology> (load<V> (inFrame), s, n);
+                store (y, outFrame);
+
+                for (size_t lane = 0; lane < groupChannels; ++lane)
+                    out[lane][n] = outFrame[lane];
+            }
+
+            for (size_t i = 0; i < numStates; ++i)
+                store (s[i], groupState + i * lanes);
+        }
+    }
+
+    static SampleType* alignedPointer (SampleType* ptr) noexcept
+    {
+       #if JUCE_USE_SIMD
+        return Vec::getNextSIMDAlignedPtr (ptr);
+       #else
+        return ptr;
+       #endif
+    }
+
+    template <typename V>
+    static V load (const SampleType* src) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            return *src;
+       #if JUCE_USE_SIMD
+        else
+            return V::fromRawArray (src);
+       #endif
+    }
+
+    template <typename V>
+    static void store (V value, SampleType* dest) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            *dest = value;
+       #if JUCE_USE_SIMD
+        else
+            value.copyToRawArray (dest);
+       #endif
+    }
+
+    /** One sample of the ladder, same arithmetic as LadderFilter::processSample. */
+    template <typename V, Saturation::Kernel kernel, Topology topology>
+    V tick (V x, V* s, size_t n) const noexcept
+    {
+        constexpr auto runtimeTaps = topology == Topology::generic || topology == Topology::fading;
+
+        const auto a1 = a1Values[n];
+        const auto b0 = b0Values[n];
+        const auto b1 = b1Values[n];
+
+        Taps t = taps;
+
+        if constexpr (topology == Topology::fading)
+        {
+            const auto amount = fadeValues[n];
+
+            for (size_t i = 0; i < numStates; ++i)
+                t.a[i] = previousTaps.a[i] + (taps.a[i] - previousTaps.a[i]) * amount;
+
+            t.comp = previousTaps.comp + (taps.comp - previousTaps.comp) * amount;
+        }
+
+        // Outside a drive glide the streams all hold driveValue, so it is read directly
+        const auto g = driveMoving ? DriveGains { driveValues[n], gainValues[n], drive2Values[n], gain2Values[n] }
+                                   : driveValue;
+
+        const auto dx = saturate<V, kernel> (x * broadcast<V> (g.drive)) * broadcast<V> (g.gain)
+                      + broadcast<V> (Saturation::denormalGuard<SampleType>);
+        auto feedback = saturate<V, kernel> (s[4] * broadcast<V> (g.drive2)) * broadcast<V> (g.gain2);
+
+        // The high passes have no compensation, so they skip the subtraction altogether
+        if constexpr (runtimeTaps)
+            feedback = feedback - dx * broadcast<V> (t.comp);
+        else if constexpr (topology != Topology::hpf12 && topology != Topology::hpf24)
+            feedback = feedback - dx * broadcast<V> (SampleType (0.5));
+
+        const auto a  = dx + feedback * broadcast<V> (feedbackValues[n]);
+        const auto b  = s[0] * broadcast<V> (b1) + s[1] * broadcast<V> (a1) + a * broadcast<V> (b0);
+        const auto c  = s[1] * broadcast<V> (b1) + s[2] * broadcast<V> (a1) + b * broadcast<V> (b0);
+        const auto d  = s[2] * broadcast<V> (b1) + s[3] * broadcast<V> (a1) + c * broadcast<V> (b0);
+        const auto e  = s[3] * broadcast<V> (b1) + s[4] * broadcast<V> (a1) + d * broadcast<V> (b0);
+
+        s[0] = a;
+        s[1] = b;
+        s[2] = c;
+        s[3] = d;
+        s[4] = e;
+
+        // Same mixes as tapsForMode, with the zero taps dropped
+        if constexpr (runtimeTaps)
+            return a * broadcast<V> (t.a[0]) + b * broadcast<V> (t.a[1]) + c * broadcast<V> (t.a[2])
+                 + d * broadcast<V> (t.a[3]) + e * broadcast<V> (t.a[4]);
+        else if constexpr (topology == Topology::lpf12)
+            return c * broadcast<V> (outputGain);
+        else if constexpr (topology == Topology::hpf12)
+            return (a + c - b * broadcast<V> (SampleType (2))) * broadcast<V> (outputGain);
+        else if constexpr (topology == Topology::bpf12)
+            return (d - c) * broadcast<V> (outputGain);
+        else if constexpr (topology == Topology::lpf24)
+            return e * broadcast<V> (outputGain);
+        else if constexpr (topology == Topology::hpf24)
+            return (a + e + c * broadcast<V> (SampleType (6)) - (b + d) * broadcast<V> (SampleType (4))) * broadcast<V> (outputGain);
+        else
+            return (c + e - d * broadcast<V> (SampleType (2))) * broadcast<V> (outputGain);
+    }
+
+    //==============================================================================
+    SampleType resonance;
+    SampleType cutoffFreqScaler;
+
+    // Cutoff glides exponentially in Hz; the transform is only evaluated at control points
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative> cutoffSmoother { SampleType (200) };
+    juce::SmoothedValue<SampleType> scaledResonanceSmoother;
+    juce::SmoothedValue<SampleType> driveSmoother { SampleType (1) };
+    int rampLength = 0;
+
+    int controlInterval = 16, controlCountdown = 0, samplesSinceControlPoint = 0;
+    juce::uint64 coefficientUpdates = 0;
+    SampleType a1Value {}, a1Target {}, a1Step {};
+    SampleType feedbackValue {}, feedbackTarget {}, feedbackStep {};
+    DriveGains driveValue {}, driveTarget {}, driveStep {};
+    bool driveMoving = false;   // whether the current chunk needs the drive streams
+    SampleType log2A1Value {}, log2A1Target {}, log2A1Step {};
+    SampleType maxCutoff {}, minLog2A1 {}, maxLog2A1 {};
+    bool targetsStale = false;  // the constant modulation changed while nothing else moved
+
+    const SampleType* cutoffModulation = nullptr;
+    const SampleType* resonanceModulation = nullptr;
+    SampleType constantCutoffRatio = SampleType (1), constantFeedbackOffset = SampleType (0);
+
+    juce::SharedResourcePointer<Saturation::SharedTables> sharedTables;
+    const juce::dsp::LookupTableTransform<SampleType>& saturationLUT = sharedTables->template getTanh<SampleType>();
+
+    Saturation::Kernel saturation = Saturation::Kernel::lookupTable;
+    Mode mode = Mode::LPF12;
+    Taps taps {}, previousTaps {};
+    int tapFadeLength = 1, tapFadeRemaining = 0;
+
+    size_t numChannels = 0, numGroups = 0, maxBlockSize = 1;
+    bool useSimd = false, useSpecialisedKernels = true;
+    Layout layout = Layout::automatic;
+
+    GroupProcessor steadyProcessor = nullptr, fadingProcessor = nullptr;
+    std::vector<const SampleType*> inputPointers;
+    std::vector<SampleType*> outputPointers;
+
+    // Group-major, then stage, then lane, so one group's stage loads straight into a register.
+    // The storage is padded by one register so the state can start on a SIMD boundary.
+    std::vector<SampleType> stateStorage, layoutScratch;
+    SampleType* state = nullptr;
+    std::vector<SampleType> a1Values, log2A1Values, b0Values, b1Values, feedbackValues, fadeValues;
+    std::vector<SampleType> driveValues, gainValues, drive2Values, gain2Values;
+};
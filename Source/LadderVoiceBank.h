@@ -0,0 +1,684 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Saturation.h"
+
+//==============================================================================
+/**
+    A bank of up to maxVoices ladders on the same input, one per held MIDI
+    note, summed to the output.
+
+    Each voice's cutoff is the base cutoff tracked from middle C by the note
+    (keytracking 1 follows the keyboard exactly) and shifted down by up to
+    velocityOctaves for soft notes. Voices open with a short attack and ring
+    out over the release after their note-off, so chords filter the input
+    through a resonant peak per note.
+
+    The ladder state, coefficients and envelopes are laid out voice-major in
+    SIMD lanes, so one instruction stream runs SIMDRegister::size() voices and
+    a group with no sounding voice is skipped outright. In a group that does
+    run, the lanes of free voices get no input, so they stay at zero until a
+    note takes them. The input saturation is shared by every voice and worked
+    out once per sample. Voices live in a
+    fixed table: note-on takes a free slot, or steals the oldest released
+    voice and then the oldest held one, and nothing is ever allocated on the
+    audio thread.
+
+    Topology, coefficient mapping and saturation are the same as LadderEngine.
+    Mode changes crossfade the output taps over a few milliseconds, as there.
+
+    The notes come from the processor's MIDI input. The AU is an aufx effect,
+    and most AU hosts (Logic among them) only route MIDI to music effects, so
+    there the bank gets no notes and stays silent; the VST3 takes MIDI
+    wherever the host routes it.
+*/
+template <typename SampleType>
+class LadderVoiceBank
+{
+public:
+    using Mode = juce::dsp::LadderFilterMode;
+
+    static constexpr int maxVoices = 16;
+    static constexpr SampleType velocityOctaves = SampleType (4);
+
+   #if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = Vec::SIMDNumElements;
+    static constexpr size_t laneAlignment = Vec::SIMDRegisterSize;
+   #else
+    using Vec = SampleType;
+    static constexpr size_t numLanes = 1;
+    static constexpr size_t laneAlignment = alignof (SampleType);
+   #endif
+
+    static constexpr size_t numGroups = (size_t) maxVoices / numLanes;
+    static_assert ((size_t) maxVoices % numLanes == 0, "voices must fill whole registers");
+
+    LadderVoiceBank()
+    {
+        setSampleRate (SampleType (1000));
+        setResonance (SampleType (0));
+        setDrive (SampleType (1.2));
+        taps = previousTaps = tapsForMode (mode);
+    }
+
+    //==============================================================================
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = (size_t) spec.numChannels;
+        stateStorage.assign (numChannels * numGroups * numStates * numLanes + numLanes, SampleType (0));
+        state = alignedPointer (stateStorage.data());
+        inputValues.assign (juce::jmax ((size_t) 1, (size_t) spec.maximumBlockSize), SampleType (0));
+
+        setSampleRate (SampleType (spec.sampleRate));
+        reset();
+    }
+
+    /** Silences and frees every voice. */
+    void reset() noexcept
+    {
+        for (auto& v : voices)
+            v = {};
+
+        std::fill (std::begin (envelope), std::end (envelope), SampleType (0));
+        std::fill (std::begin (envelopeStep), std::end (envelopeStep), SampleType (0));
+        resetState();
+    }
+
+    /** Clears the ladder state but keeps the voices playing. */
+    void resetState() noexcept
+    {
+        std::fill (stateStorage.begin(), stateStorage.end(), SampleType (0));
+        cutoffSmoother.setCurrentAndTargetValue (cutoffSmoother.getTargetValue());
+        resonanceSmoother.setCurrentAndTargetValue (resonanceSmoother.getTargetValue());
+        driveSmoother.setCurrentAndTargetValue (driveSmoother.getTargetValue());
+        updateDriveGains (driveSmoother.getTargetValue());
+        previousTaps = taps;
+        tapFadeRemaining = 0;
+    }
+
+    //==============================================================================
+    /** Changes the rate the voices run at without reallocating, e.g. for oversampling. */
+    void setSampleRate (SampleType newValue) noexcept
+    {
+        jassert (newValue > SampleType (0));
+        cutoffFreqScaler = SampleType (-2.0 * juce::MathConstants<double>::pi) / newValue;
+        maxCutoff = juce::jmin (SampleType (20000), newValue * SampleType (0.45));
+
+        static constexpr SampleType smootherRampTimeSec = SampleType (0.05);
+        cutoffSmoother.reset (newValue, smootherRampTimeSec);
+        resonanceSmoother.reset (newValue, smootherRampTimeSec);
+        driveSmoother.reset (newValue, smootherRampTimeSec);
+        updateDriveGains (driveSmoother.getTargetValue());
+        rampLength = juce::roundToInt (newValue * smootherRampTimeSec);
+        tapFadeLength = juce::jmax (1, juce::roundToInt (newValue * SampleType (tapFadeSeconds)));
+        tapFadeRemaining = juce::jmin (tapFadeRemaining, tapFadeLength);
+
+        attackStep  = SampleType (1) / juce::jmax (SampleType (1), newValue * SampleType (attackSeconds));
+        releaseStep = SampleType (1) / juce::jmax (SampleType (1), newValue * SampleType (releaseSeconds));
+
+        for (int v = 0; v < maxVoices; ++v)
+            if (voices[(size_t) v].note >= 0)
+                envelopeStep[v] = voices[(size_t) v].held ? attackStep : -releaseStep;
+    }
+
+    /** Samples between coefficient updates; the voices' coefficients hold still in between. */
+    void setControlInterval (int numSamples) noexcept    { controlInterval = juce::jmax (1, numSamples); }
+
+    /** Samples the cutoff, resonance and drive take to reach a new target, as LadderEngine::setRampLength. */
+    void setRampLength (int numSamples) noexcept
+    {
+        numSamples = juce::jmax (1, numSamples);
+
+        if (numSamples == rampLength)
+            return;
+
+        rampLength = numSamples;
+        setRampSteps (cutoffSmoother, rampLength);
+        setRampSteps (resonanceSmoother, rampLength);
+        setRampSteps (driveSmoother, rampLength);
+    }
+
+    void setCutoffFrequencyHz (SampleType newCutoff) noexcept
+    {
+        jassert (newCutoff > SampleType (0));
+        cutoffSmoother.setTargetValue (newCutoff);
+    }
+
+    void setResonance (SampleType newResonance) noexcept
+    {
+        jassert (newResonance >= SampleType (0) && newResonance <= SampleType (1));
+        resonanceSmoother.setTargetValue (juce::jmap (newResonance, SampleType (0.1), SampleType (1)));
+    }
+
+    void setDrive (SampleType newDrive) noexcept
+    {
+        jassert (newDrive >= SampleType (1));
+        driveSmoother.setTargetValue (newDrive);
+
+        if (! driveSmoother.isSmoothing())
+            updateDriveGains (newDrive);
+    }
+
+    /** Switches the output taps, crossfaded from the ones heard now. */
+    void setMode (Mode newMode) noexcept
+    {
+        if (newMode == mode)
+            return;
+
+        previousTaps = tapsAt (tapFadeRemaining);
+        taps = tapsForMode (newMode);
+        mode = newMode;
+        tapFadeRemaining = tapFadeLength;
+    }
+
+    void setSaturation (Saturation::Kernel newKernel) noexcept     { saturation = newKernel; }
+
+    /** 0 keeps every voice at the base cutoff, 1 tracks the keyboard one octave per octave. */
+    void setKeytracking (SampleType amount) noexcept               { keytracking = amount; }
+
+    /** 0 ignores velocity; 1 takes a note at velocity 0 velocityOctaves below one at full velocity. */
+    void setVelocitySensitivity (SampleType amount) noexcept       { velocitySensitivity = amount; }
+
+    int getNumActiveVoices() const noexcept
+    {
+        return (int) std::count_if (voices.begin(), voices.end(), [] (const Voice& v) { return v.note >= 0; });
+    }
+
+    /** True once no voice is sounding and every stage has rung out below the threshold. */
+    bool hasDecayed (SampleType threshold) const noexcept
+    {
+        return getNumActiveVoices() == 0
+            && std::all_of (stateStorage.begin(), stateStorage.end(),
+                            [threshold] (SampleType v) { return std::abs (v) <= threshold; });
+    }
+
+    //==============================================================================
+    /** Filters block in place through every sounding voice.
+
+        midi is the host's buffer for the whole processBlock call. Events from
+        midiStart onwards that fall inside this block are applied at their sample
+        position; samplesPerEvent is the oversampling factor the block runs at.
+    */
+    void process (const juce::dsp::AudioBlock<SampleType>& block, const juce::MidiBuffer& midi,
+                  int midiStart, int samplesPerEvent) noexcept
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto midiEnd = midiStart + (numSamples + samplesPerEvent - 1) / samplesPerEvent;
+        int rendered = 0;
+
+        for (auto it = midi.findNextSamplePosition (midiStart); it != midi.cend(); ++it)
+        {
+            const auto event = *it;
+
+            if (event.samplePosition >= midiEnd)
+                break;
+
+            const auto position = juce::jmin (numSamples, (event.samplePosition - midiStart) * samplesPerEvent);
+
+            if (position > rendered)
+                render (block.getSubBlock ((size_t) rendered, (size_t) (position - rendered)));
+
+            rendered = juce::jmax (rendered, position);
+            handleMessage (event.getMessage());
+        }
+
+        if (numSamples > rendered)
+            render (block.getSubBlock ((size_t) rendered, (size_t) (numSamples - rendered)));
+    }
+
+    /** Applies note-ons and offs without rendering, e.g. while the processor sleeps or is
+        bypassed; envelopes jump to where they are heading so no voice gets stuck. */
+    void handleMidi (const juce::MidiBuffer& midi) noexcept
+    {
+        for (const auto event : midi)
+            handleMessage (event.getMessage());
+
+        for (int v = 0; v < maxVoices; ++v)
+        {
+            envelope[v] = voices[(size_t) v].held ? SampleType (1) : SampleType (0);
+
+            if (! voices[(size_t) v].held)
+                freeVoice ((size_t) v);
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr size_t numStates = 5;
+    static constexpr SampleType outputGain = SampleType (1.2);
+    static constexpr double tapFadeSeconds = 0.01;
+    static constexpr double attackSeconds = 0.003, releaseSeconds = 0.1;
+    static constexpr int middleC = 60;
+
+    struct Voice
+    {
+        int note = -1;              // -1 while free
+        SampleType velocity = 0;
+        juce::uint32 startedAt = 0;
+        bool held = false;
+    };
+
+    struct Taps
+    {
+        SampleType a[numStates];
+        SampleType comp;
+    };
+
+    static Taps tapsForMode (Mode m) noexcept
+    {
+        Taps t {};
+
+        switch (m)
+        {
+            case Mode::LPF12:   t = { { 0, 0,  1,  0, 0 }, SampleType (0.5) }; break;
+            case Mode::HPF12:   t = { { 1, -2, 1,  0, 0 }, SampleType (0) };   break;
+            case Mode::BPF12:   t = { { 0, 0, -1,  1, 0 }, SampleType (0.5) }; break;
+            case Mode::LPF24:   t = { { 0, 0,  0,  0, 1 }, SampleType (0.5) }; break;
+            case Mode::HPF24:   t = { { 1, -4, 6, -4, 1 }, SampleType (0) };   break;
+            case Mode::BPF24:   t = { { 0, 0,  1, -2, 1 }, SampleType (0.5) }; break;
+            default:            jassertfalse; break;
+        }
+
+        for (auto& a : t.a)
+            a *= outputGain;
+
+        return t;
+    }
+
+    /** The taps with remaining samples of the fade still to go. */
+    Taps tapsAt (int remaining) const noexcept
+    {
+        if (remaining <= 0)
+            return taps;
+
+        const auto amount = SampleType (1) - (SampleType) remaining / (SampleType) tapFadeLength;
+        Taps t;
+
+        for (size_t i = 0; i < numStates; ++i)
+            t.a[i] = previousTaps.a[i] + (taps.a[i] - previousTaps.a[i]) * amount;
+
+        t.comp = previousTaps.comp + (taps.comp - previousTaps.comp) * amount;
+        return t;
+    }
+
+    //==============================================================================
+    void handleMessage (const juce::MidiMessage& message) noexcept
+    {
+        if (message.isNoteOn())
+            noteOn (message.getNoteNumber(), (SampleType) message.getFloatVelocity());
+        else if (message.isNoteOff())
+            noteOff (message.getNoteNumber());
+        else if (message.isAllNotesOff() || message.isAllSoundOff())
+            for (auto& v : voices)
+                if (v.note >= 0)
+                    release (v);
+    }
+
+    void noteOn (int note, SampleType velocity) noexcept
+    {
+        int chosen = -1;
+
+        // Retrigger the same note, else take a free voice, else steal the oldest
+        // released voice, else the oldest held one
+        for (int v = 0; v < maxVoices && chosen < 0; ++v)
+            if (voices[(size_t) v].note == note)
+                chosen = v;
+
+        for (int v = 0; v < maxVoices && chosen < 0; ++v)
+            if (voices[(size_t) v].note < 0)
+                chosen = v;
+
+        for (auto held : { false, true })
+        {
+            for (int v = 0; v < maxVoices && chosen < 0; ++v)
+            {
+                if (voices[(size_t) v].held != held)
+                    continue;
+
+                chosen = v;
+
+                for (int other = v + 1; other < maxVoices; ++other)
+                    if (voices[(size_t) other].held == held
+                         && voices[(size_t) other].startedAt - voiceCounter < voices[(size_t) chosen].startedAt - voiceCounter)
+                        chosen = other;
+            }
+        }
+
+        auto& voice = voices[(size_t) chosen];
+
+        if (voice.note != note)
+        {
+            clearVoiceState ((size_t) chosen);
+            envelope[chosen] = SampleType (0);
+        }
+
+        voice.note = note;
+        voice.velocity = velocity;
+        voice.startedAt = voiceCounter++;
+        voice.held = true;
+        envelopeStep[chosen] = attackStep;
+    }
+
+    void noteOff (int note) noexcept
+    {
+        for (auto& v : voices)
+            if (v.note == note && v.held)
+                release (v);
+    }
+
+    void release (Voice& v) noexcept
+    {
+        v.held = false;
+        envelopeStep[&v - voices.data()] = -releaseStep;
+    }
+
+    /** Silent by now; its lanes are cleared, and being masked they stay clear, so hasDecayed()
+        only waits on sounding voices. */
+    void freeVoice (size_t voice) noexcept
+    {
+        if (voices[voice].note >= 0)
+            clearVoiceState (voice);
+
+        voices[voice] = {};
+    }
+
+    void clearVoiceState (size_t voice) noexcept
+    {
+        const auto group = voice / numLanes;
+        const auto lane = voice % numLanes;
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (size_t i = 0; i < numStates; ++i)
+                groupState (ch, group)[i * numLanes + lane] = SampleType (0);
+    }
+
+    SampleType* groupState (size_t channel, size_t group) const noexcept
+    {
+        return state + (channel * numGroups + group) * numStates * numLanes;
+    }
+
+    //==============================================================================
+    /** Renders one stretch with no MIDI in it, a control period at a time. */
+    void render (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numSamples = block.getNumSamples();
+
+        for (size_t start = 0; start < numSamples; start += (size_t) controlInterval)
+        {
+            const auto chunk = block.getSubBlock (start, juce::jmin ((size_t) controlInterval, numSamples - start));
+
+            switch (saturation)
+            {
+                case Saturation::Kernel::pade:          renderChunk<Saturation::Kernel::pade> (chunk); break;
+                case Saturation::Kernel::polynomial:    renderChunk<Saturation::Kernel::polynomial> (chunk); break;
+                case Saturation::Kernel::lookupTable:
+                default:                                renderChunk<Saturation::Kernel::lookupTable> (chunk); break;
+            }
+        }
+    }
+
+    void updateDriveGains (SampleType newDrive) noexcept
+    {
+        drive = newDrive;
+        gain = std::pow (drive, SampleType (-2.642)) * SampleType (0.6103) + SampleType (0.3903);
+        drive2 = drive * SampleType (0.04) + SampleType (0.96);
+        gain2 = std::pow (drive2, SampleType (-2.642)) * SampleType (0.6103) + SampleType (0.3903);
+    }
+
+    /** Gives a smoother a new ramp length; reset() would jump it to its target, so the value is put back. */
+    template <typename Smoother>
+    static void setRampSteps (Smoother& smoother, int numSteps) noexcept
+    {
+        const auto current = smoother.getCurrentValue();
+        const auto target = smoother.getTargetValue();
+
+        smoother.reset (numSteps);
+        smoother.setCurrentAndTargetValue (current);
+        smoother.setTargetValue (target);
+    }
+
+    /** Per voice coefficients for the chunk, from the smoothed base cutoff, the note and the velocity. */
+    void updateCoefficients (int numSamples) noexcept
+    {
+        const auto baseCutoff = cutoffSmoother.skip (numSamples);
+        feedback = resonanceSmoother.skip (numSamples) * SampleType (-4);
+
+        if (driveSmoother.isSmoothing())
+            updateDriveGains (driveSmoother.skip (numSamples));
+
+        for (int v = 0; v < maxVoices; ++v)
+        {
+            const auto& voice = voices[(size_t) v];
+
+            if (voice.note < 0)
+                continue;
+
+            const auto octaves = keytracking * (SampleType) (voice.note - middleC) / SampleType (12)
+                               + velocitySensitivity * velocityOctaves * (voice.velocity - SampleType (1));
+            const auto cutoff = juce::jlimit (SampleType (20), maxCutoff, baseCutoff * std::exp2 (octaves));
+
+            a1[v] = std::exp (cutoff * cutoffFreqScaler);
+            b0[v] = (SampleType (1) - a1[v]) * SampleType (0.76923076923);
+            b1[v] = (SampleType (1) - a1[v]) * SampleType (0.23076923076);
+        }
+    }
+
+    template <Saturation::Kernel kernel>
+    void renderChunk (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numSamples = block.getNumSamples();
+        updateCoefficients ((int) numSamples);
+
+        bool groupActive[numGroups] {};
+
+        for (int v = 0; v < maxVoices; ++v)
+        {
+            const auto sounding = voices[(size_t) v].note >= 0;
+            groupActive[(size_t) v / numLanes] |= sounding;
+            inputMask[v] = sounding ? SampleType (1) : SampleType (0);
+        }
+
+        // A mode change fades the taps across the chunk, sample by sample
+        const auto fadeEnd = juce::jmax (0, tapFadeRemaining - (int) numSamples);
+        const auto chunkTaps = tapsAt (tapFadeRemaining);
+        Taps tapSteps {};
+
+        if (tapFadeRemaining > 0)
+        {
+            const auto endTaps = tapsAt (fadeEnd);
+            const auto scale = SampleType (1) / (SampleType) numSamples;
+
+            for (size_t i = 0; i < numStates; ++i)
+                tapSteps.a[i] = (endTaps.a[i] - chunkTaps.a[i]) * scale;
+
+            tapSteps.comp = (endTaps.comp - chunkTaps.comp) * scale;
+        }
+
+        const auto fading = tapFadeRemaining > 0;
+        tapFadeRemaining = fadeEnd;
+
+        for (size_t ch = 0; ch < juce::jmin (numChannels, block.getNumChannels()); ++ch)
+        {
+            auto* data = block.getChannelPointer (ch);
+
+            // The input stage is the same for every voice, denormal guard included
+            for (size_t n = 0; n < numSamples; ++n)
+                inputValues[n] = saturate<SampleType, kernel> (data[n] * drive) * gain + Saturation::denormalGuard<SampleType>;
+
+            std::fill (data, data + numSamples, SampleType (0));
+
+            for (size_t group = 0; group < numGroups; ++group)
+                if (groupActive[group])
+                    renderGroup<kernel> (data, numSamples, ch, group, chunkTaps, tapSteps, fading);
+        }
+
+        // Advance the envelopes once for the chunk and free voices that have finished releasing
+        for (int v = 0; v < maxVoices; ++v)
+        {
+            envelope[v] = juce::jlimit (SampleType (0), SampleType (1), envelope[v] + envelopeStep[v] * (SampleType) numSamples);
+
+            if (! voices[(size_t) v].held && envelope[v] <= SampleType (0))
+                freeVoice ((size_t) v);
+        }
+    }
+
+    template <Saturation::Kernel kernel>
+    void renderGroup (SampleType* output, size_t numSamples, size_t channel, size_t group,
+                      const Taps& startTaps, const Taps& tapSteps, bool fading) noexcept
+    {
+        const auto first = group * numLanes;
+        auto* groupStorage = groupState (channel, group);
+
+        V s[numStates];
+
+        for (size_t i = 0; i < numStates; ++i)
+            s[i] = load (groupStorage + i * numLanes);
+
+        const auto va1 = load (a1 + first);
+        const auto vb0 = load (b0 + first);
+        const auto vb1 = load (b1 + first);
+        const auto step = load (envelopeStep + first);
+        const auto mask = load (inputMask + first);
+        auto level = load (envelope + first);
+
+        const auto vFeedback = broadcast (feedback);
+        const auto vDrive2 = broadcast (drive2);
+        const auto vGain2 = broadcast (gain2);
+        V vTaps[numStates], vTapSteps[numStates];
+
+        for (size_t i = 0; i < numStates; ++i)
+        {
+            vTaps[i] = broadcast (startTaps.a[i]);
+            vTapSteps[i] = broadcast (tapSteps.a[i]);
+        }
+
+        auto vComp = broadcast (startTaps.comp);
+        const auto vCompStep = broadcast (tapSteps.comp);
+
+        for (size_t n = 0; n < numSamples; ++n)
+        {
+            // Free lanes run on stale coefficients, so they are fed silence instead of the input
+            const auto dx = broadcast (inputValues[n]) * mask;
+            const auto fb = saturate<V, kernel> (s[4] * vDrive2) * vGain2 - dx * vComp;
+
+            const auto a = dx + fb * vFeedback;
+            const auto b = s[0] * vb1 + s[1] * va1 + a * vb0;
+            const auto c = s[1] * vb1 + s[2] * va1 + b * vb0;
+            const auto d = s[2] * vb1 + s[3] * va1 + c * vb0;
+            const auto e = s[3] * vb1 + s[4] * va1 + d * vb0;
+
+            s[0] = a;
+            s[1] = b;
+            s[2] = c;
+            s[3] = d;
+            s[4] = e;
+
+            // Ramp the envelopes, held within [0, 1]
+            level = Saturation::clamp<SampleType> (level + step - broadcast (SampleType (0.5)), SampleType (0.5))
+                      + broadcast (SampleType (0.5));
+
+            const auto y = a * vTaps[0] + b * vTaps[1] + c * vTaps[2] + d * vTaps[3] + e * vTaps[4];
+
+            output[n] += sum (y * level);
+
+            if (fading)
+            {
+                for (size_t i = 0; i < numStates; ++i)
+                    vTaps[i] = vTaps[i] + vTapSteps[i];
+
+                vComp = vComp + vCompStep;
+            }
+        }
+
+        for (size_t i = 0; i < numStates; ++i)
+            store (s[i], groupStorage + i * numLanes);
+    }
+
+    //==============================================================================
+    using V = Vec;
+
+    template <typename T, Saturation::Kernel kernel>
+    T saturate (T x) const noexcept
+    {
+        if constexpr (kernel == Saturation::Kernel::pade)
+            return Saturation::pade<SampleType> (x);
+        else if constexpr (kernel == Saturation::Kernel::polynomial)
+            return Saturation::polynomial<SampleType> (x);
+        else
+            return Saturation::perLane<SampleType> (x, [this] (SampleType v) { return saturationLUT (v); });
+    }
+
+    static V broadcast (SampleType value) noexcept      { return Saturation::broadcast<SampleType, V> (value); }
+
+    static V load (const SampleType* src) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            return *src;
+       #if JUCE_USE_SIMD
+        else
+            return V::fromRawArray (src);
+       #endif
+    }
+
+    static void store (V value, SampleType* dest) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            *dest = value;
+       #if JUCE_USE_SIMD
+        else
+            value.copyToRawArray (dest);
+       #endif
+    }
+
+    static SampleType sum (V value) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            return value;
+       #if JUCE_USE_SIMD
+        else
+            return value.sum();
+       #endif
+    }
+
+    static SampleType* alignedPointer (SampleType* ptr) noexcept
+    {
+       #if JUCE_USE_SIMD
+        return Vec::getNextSIMDAlignedPtr (ptr);
+       #else
+        return ptr;
+       #endif
+    }
+
+    //==============================================================================
+    SampleType drive, gain, drive2, gain2;
+    SampleType cutoffFreqScaler = 0, maxCutoff = 20000;
+    SampleType keytracking = 1, velocitySensitivity = 0;
+    SampleType attackStep = 1, releaseStep = 1, feedback = 0;
+
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative> cutoffSmoother { SampleType (200) };
+    juce::SmoothedValue<SampleType> resonanceSmoother;
+    juce::SmoothedValue<SampleType> driveSmoother { SampleType (1) };
+    int controlInterval = 16, rampLength = 0;
+
+    juce::SharedResourcePointer<Saturation::SharedTables> sharedTables;
+    const juce::dsp::LookupTableTransform<SampleType>& saturationLUT = sharedTables->template getTanh<SampleType>();
+
+    Saturation::Kernel saturation = Saturation::Kernel::lookupTable;
+    Mode mode = Mode::LPF12;
+    Taps taps {}, previousTaps {};
+    int tapFadeLength = 1, tapFadeRemaining = 0;
+
+    // Voice-major, so each group of lanes loads straight into a register
+    std::array<Voice, (size_t) maxVoices> voices;
+    juce::uint32 voiceCounter = 0;
+    alignas (laneAlignment) SampleType a1[maxVoices] {}, b0[maxVoices] {}, b1[maxVoices] {};
+    alignas (laneAlignment) SampleType envelope[maxVoices] {}, envelopeStep[maxVoices] {};
+    alignas (laneAlignment) SampleType inputMask[maxVoices] {};
+
+    // Channel, then group, then stage, then lane; padded by one register for alignment
+    size_t numChannels = 0;
+    std::vector<SampleType> stateStorage;
+    SampleType* state = nullptr;
+    std::vector<SampleType> inputValues;
+};
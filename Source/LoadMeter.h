@@ -0,0 +1,67 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PerformanceMonitor.h"
+
+//==============================================================================
+/**
+    DSP load bar plus block timing and latency, fed from PerformanceMonitor
+    stats by the editor's timer. Repaints only when the rounded figures change.
+*/
+class LoadMeter  : public juce::Component
+{
+public:
+    void update (const PerformanceStats& stats, double latencyMs)
+    {
+        const Reading next { juce::roundToInt (stats.deadlineShare * 1000.0),
+                             juce::roundToInt (stats.peakDeadlineShare * 1000.0),
+                             juce::roundToInt (stats.p99Micros * 10.0),
+                             juce::roundToInt (latencyMs * 10.0) };
+
+        if (next == reading)
+            return;
+
+        reading = next;
+        repaint();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        auto bounds = getLocalBounds().toFloat();
+        auto bar = bounds.removeFromLeft (bounds.getWidth() * 0.3f).reduced (0.0f, 4.0f);
+
+        g.setColour (juce::Colours::black.withAlpha (0.3f));
+        g.fillRect (bar);
+
+        const auto load = juce::jlimit (0.0f, 1.0f, (float) reading.load / 1000.0f);
+        const auto peak = juce::jlimit (0.0f, 1.0f, (float) reading.peak / 1000.0f);
+
+        g.setColour (load < 0.5f ? juce::Colours::limegreen : load < 0.8f ? juce::Colours::orange : juce::Colours::red);
+        g.fillRect (bar.withWidth (bar.getWidth() * load));
+
+        g.setColour (juce::Colours::white);
+        g.fillRect (bar.getX() + bar.getWidth() * peak - 1.0f, bar.getY(), 2.0f, bar.getHeight());
+
+        juce::String text;
+        text << "DSP " << juce::String (reading.load / 10.0, 1) << "%  p99 "
+             << juce::String (reading.p99 / 10.0, 1) << " us  latency "
+             << juce::String (reading.latency / 10.0, 1) << " ms";
+
+        g.setFont (12.0f);
+        g.drawText (text, bounds.withTrimmedLeft (6.0f), juce::Justification::centredLeft);
+    }
+
+private:
+    /** Fixed point copies of the figures on screen, so small jitter doesn't trigger a repaint. */
+    struct Reading
+    {
+        int load = 0, peak = 0, p99 = 0, latency = 0;
+
+        bool operator== (const Reading& other) const noexcept
+        {
+            return load == other.load && peak == other.peak && p99 == other.p99 && latency == other.latency;
+        }
+    };
+
+    Reading reading;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Wraps the ladder in juce::dsp::Oversampling at 1x, 2x, 4x or 8x.
+
+    Stages are built on demand, so only the factors and filter designs that
+    get used take memory. select() never allocates: asking for a stage that
+    has not been built yet leaves the current one playing and flags the
+    request, build() then makes it off the audio thread, and the next
+    select() switches over with a pointer change. Built stages are kept
+    until the next prepare() or release(). Instantiated for float and
+    double, like the ladder.
+*/
+template <typename SampleType>
+class OversamplingStage
+{
+public:
+    static constexpr int maxOrder = 3;  // 2^3 = 8x
+
+    enum class FilterDesign
+    {
+        minimumPhase,   // polyphase IIR, low latency
+        linearPhase     // equiripple FIR, higher latency
+    };
+
+    /** Frees any stages from before; select() and build() then make the ones needed at this size. */
+    void prepare (int newNumChannels, int newMaximumBlockSize)
+    {
+        const juce::ScopedLock sl (buildLock);
+
+        freeStages();
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+    }
+
+    /** Frees every stage; prepare() has to be called again before processing. */
+    void release()
+    {
+        const juce::ScopedLock sl (buildLock);
+        freeStages();
+    }
+
+    /** Picks the factor (as a power of two) and filter design. Returns true if anything changed.
+        A stage that has not been built is requested instead (see isBuildPending) and the
+        current one stays selected. */
+    bool select (int order, FilterDesign design) noexcept
+    {
+        order = juce::jlimit (0, maxOrder, order);
+        juce::dsp::Oversampling<SampleType>* next = nullptr;
+
+        if (order > 0)
+        {
+            const auto slot = slotFor (order, design);
+            next = stages[slot].load (std::memory_order_acquire);
+
+            if (next == nullptr)
+            {
+                requestedSlot.store (slot, std::memory_order_release);
+                return false;
+            }
+        }
+
+        requestedSlot.store (-1, std::memory_order_relaxed);
+
+        if (next == current && order == currentOrder)
+            return false;
+
+        current = next;
+        currentOrder = order;
+
+        if (current != nullptr)
+            current->reset();
+
+        return true;
+    }
+
+    /** True when select() asked for a stage that build() has not made yet. */
+    bool isBuildPending() const noexcept    { return requestedSlot.load (std::memory_order_acquire) >= 0; }
+
+    /** Builds the stage select() last asked for, if any. Allocates, so call it from the message
+        thread, or from the audio thread only while rendering offline. */
+    void build()
+    {
+        const juce::ScopedLock sl (buildLock);
+        const auto slot = requestedSlot.load (std::memory_order_acquire);
+
+        if (slot >= 0 && stages[slot].load (std::memory_order_acquire) == nullptr && maximumBlockSize > 0)
+            buildStage (slot);
+    }
+
+    int getFactor() const noexcept      { return 1 << currentOrder; }
+
+    /** Clears the filter state of the selected stage. */
+    void reset() noexcept
+    {
+        if (current != nullptr)
+            current->reset();
+    }
+
+    int getLatencyInSamples() const noexcept
+    {
+        return current != nullptr ? juce::roundToInt (current->getLatencyInSamples()) : 0;
+    }
+
+    /** The largest latency select() can lead to, for sizing delay lines in prepareToPlay.
+        It depends only on the designs, so it is measured once on single channel stages that
+        never get their processing buffers. */
+    static int getMaxLatencyInSamples()
+    {
+        static const int maxLatency = []
+        {
+            int latency = 0;
+
+            for (auto type : { juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                               juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple })
+            {
+                juce::dsp::Oversampling<SampleType> probe (1, (size_t) maxOrder, type, true, true);
+                latency = juce::jmax (latency, juce::roundToInt (probe.getLatencyInSamples()));
+            }
+
+            return latency;
+        }();
+
+        return maxLatency;
+    }
+
+    /** Upsamples the block, runs processOversampled on the result and downsamples back in place. */
+    template <typename Callback>
+    void process (juce::dsp::AudioBlock<SampleType>& block, Callback&& processOversampled) noexcept
+    {
+        if (current == nullptr)
+        {
+            processOversampled (block);
+            return;
+        }
+
+        auto oversampledBlock = current->processSamplesUp (block);
+        processOversampled (oversampledBlock);
+        current->processSamplesDown (block);
+    }
+
+private:
+    static constexpr int numSlots = 2 * maxOrder;
+
+    static int slotFor (int order, FilterDesign design) noexcept
+    {
+        return (design == FilterDesign::linearPhase ? maxOrder : 0) + order - 1;
+    }
+
+    void buildStage (int slot)
+    {
+        const auto type = slot < maxOrder ? juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR
+                                          : juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple;
+
+        auto stage = std::make_unique<juce::dsp::Oversampling<SampleType>> ((size_t) numChannels, (size_t) (slot % maxOrder + 1),
+                                                                             type, true, true);
+        stage->initProcessing ((size_t) maximumBlockSize);
+
+        stages[slot].store (stage.get(), std::memory_order_release);
+        owned[slot] = std::move (stage);
+    }
+
+    void freeStages()
+    {
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            stages[slot].store (nullptr, std::memory_order_relaxed);
+            owned[slot].reset();
+        }
+
+        current = nullptr;
+        currentOrder = 0;
+        requestedSlot.store (-1, std::memory_order_relaxed);
+    }
+
+    // owned[] is only touched under buildLock; the audio thread reads the published pointers
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> owned[numSlots];
+    std::atomic<juce::dsp::Oversampling<SampleType>*> stages[numSlots] {};
+    std::atomic<int> requestedSlot { -1 };
+    juce::CriticalSection buildLock;
+
+    juce::dsp::Oversampling<SampleType>* current = nullptr;
+    int currentOrder = 0;
+    int numChannels = 0, maximumBlockSize = 0;
+};
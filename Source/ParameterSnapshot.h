@@ -0,0 +1,200 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Plain copy of the parameter values the DSP needs for one block. */
+struct LadderParameters
+{
+    float cutoff    = 2000.0f;
+    float resonance = 0.0f;
+    float drive     = 1.0f;
+    int   type      = 0;    // index into LadderFilterBasicAudioProcessor::filterTypes
+    int   quality   = 0;    // saturation kernel, see LadderFilterBasicAudioProcessor::createParameters
+
+    int   oversampling        = 0;  // factor as a power of two, 0 = 1x
+    int   oversamplingFilter  = 0;  // 0 = minimum phase IIR, 1 = linear phase FIR
+    int   offlineOversampling = 0;  // factor used when rendering offline, 0 = same as realtime
+
+    bool  bypass = false;
+
+    bool  voiceBank  = false;   // polyphonic keytracked voices instead of the single ladder
+    float keytrack   = 1.0f;
+    float velocity   = 0.0f;    // velocity to cutoff amount
+
+    float sidechainCutoff    = 0.0f;    // octaves of cutoff per unit of sidechain signal
+    float sidechainResonance = 0.0f;    // resonance per unit of sidechain signal
+
+    float morph       = 0.0f;   // blend towards the morph target program, see PresetBank
+    int   morphTarget = 0;
+};
+
+//==============================================================================
+/**
+    Resolves the raw parameter atomics of the APVTS once, so that processBlock
+    never has to look a parameter up by its string ID on the audio thread.
+
+    Every parameter also gets a listener that sets its bit in a dirty mask, so
+    the audio thread can skip all coefficient work on blocks where nothing moved.
+*/
+class ParameterSnapshot
+{
+public:
+    enum DirtyFlags : juce::uint32
+    {
+        cutoffDirty    = 1 << 0,
+        resonanceDirty = 1 << 1,
+        driveDirty     = 1 << 2,
+        typeDirty         = 1 << 3,
+        oversamplingDirty = 1 << 4,
+        qualityDirty      = 1 << 5,
+        bypassDirty       = 1 << 6,
+        voicesDirty       = 1 << 7,
+        sidechainDirty    = 1 << 8,
+        morphDirty        = 1 << 9,
+        allDirty          = cutoffDirty | resonanceDirty | driveDirty | typeDirty | oversamplingDirty | qualityDirty | bypassDirty
+                          | voicesDirty | sidechainDirty | morphDirty
+    };
+
+    ParameterSnapshot() = default;
+
+    ~ParameterSnapshot()
+    {
+        if (state != nullptr)
+            for (auto& w : watchers)
+                state->removeParameterListener (w.parameterID, &w);
+    }
+
+    void attachTo (juce::AudioProcessorValueTreeState& apvts)
+    {
+        jassert (state == nullptr);
+        state = &apvts;
+
+        cutoff    = apvts.getRawParameterValue ("CUTOFF");
+        resonance = apvts.getRawParameterValue ("RESONANCE");
+        drive     = apvts.getRawParameterValue ("DRIVE");
+        type      = apvts.getRawParameterValue ("TYPE");
+        quality   = apvts.getRawParameterValue ("QUALITY");
+
+        oversampling        = apvts.getRawParameterValue ("OVERSAMPLING");
+        oversamplingFilter  = apvts.getRawParameterValue ("OS_FILTER");
+        offlineOversampling = apvts.getRawParameterValue ("OFFLINE_OS");
+        bypass              = apvts.getRawParameterValue ("BYPASS");
+
+        voiceBank = apvts.getRawParameterValue ("VOICES");
+        keytrack  = apvts.getRawParameterValue ("KEYTRACK");
+        velocity  = apvts.getRawParameterValue ("VELOCITY");
+
+        sidechainCutoff    = apvts.getRawParameterValue ("SC_CUTOFF");
+        sidechainResonance = apvts.getRawParameterValue ("SC_RESONANCE");
+
+        morph       = apvts.getRawParameterValue ("MORPH");
+        morphTarget = apvts.getRawParameterValue ("MORPH_TARGET");
+
+        jassert (cutoff != nullptr && resonance != nullptr && drive != nullptr && type != nullptr && quality != nullptr);
+        jassert (oversampling != nullptr && oversamplingFilter != nullptr && offlineOversampling != nullptr);
+        jassert (bypass != nullptr);
+        jassert (voiceBank != nullptr && keytrack != nullptr && velocity != nullptr);
+        jassert (sidechainCutoff != nullptr && sidechainResonance != nullptr);
+        jassert (morph != nullptr && morphTarget != nullptr);
+
+        for (auto& w : watchers)
+        {
+            w.dirtyMask = &dirty;
+            apvts.addParameterListener (w.parameterID, &w);
+        }
+    }
+
+    /** Reads every parameter into one packed struct. Safe to call from any thread. */
+    LadderParameters load() const noexcept
+    {
+        LadderParameters p;
+        p.cutoff    = cutoff->load (std::memory_order_relaxed);
+        p.resonance = resonance->load (std::memory_order_relaxed);
+        p.drive     = drive->load (std::memory_order_relaxed);
+        p.type      = juce::roundToInt (type->load (std::memory_order_relaxed));
+        p.quality   = juce::roundToInt (quality->load (std::memory_order_relaxed));
+
+        p.oversampling        = juce::roundToInt (oversampling->load (std::memory_order_relaxed));
+        p.oversamplingFilter  = juce::roundToInt (oversamplingFilter->load (std::memory_order_relaxed));
+        p.offlineOversampling = juce::roundToInt (offlineOversampling->load (std::memory_order_relaxed));
+        p.bypass              = bypass->load (std::memory_order_relaxed) >= 0.5f;
+
+        p.voiceBank = voiceBank->load (std::memory_order_relaxed) >= 0.5f;
+        p.keytrack  = keytrack->load (std::memory_order_relaxed);
+        p.velocity  = velocity->load (std::memory_order_relaxed);
+
+        p.sidechainCutoff    = sidechainCutoff->load (std::memory_order_relaxed);
+        p.sidechainResonance = sidechainResonance->load (std::memory_order_relaxed);
+
+        p.morph       = morph->load (std::memory_order_relaxed);
+        p.morphTarget = juce::roundToInt (morphTarget->load (std::memory_order_relaxed));
+        return p;
+    }
+
+    /** Returns the parameters that changed since the last call and clears them. */
+    juce::uint32 takeDirtyFlags() noexcept      { return dirty.exchange (0, std::memory_order_acquire); }
+
+    /** Forces the next takeDirtyFlags() to report the given parameters. */
+    void markDirty (juce::uint32 flags = allDirty) noexcept    { dirty.fetch_or (flags, std::memory_order_release); }
+
+private:
+    //==============================================================================
+    struct Watcher  : public juce::AudioProcessorValueTreeState::Listener
+    {
+        Watcher (const char* id, juce::uint32 flag) : parameterID (id), bit (flag) {}
+
+        void parameterChanged (const juce::String&, float) override
+        {
+            dirtyMask->fetch_or (bit, std::memory_order_release);
+        }
+
+        const juce::String parameterID;
+        const juce::uint32 bit;
+        std::atomic<juce::uint32>* dirtyMask = nullptr;
+    };
+
+    juce::AudioProcessorValueTreeState* state = nullptr;
+
+    std::atomic<float>* cutoff    = nullptr;
+    std::atomic<float>* resonance = nullptr;
+    std::atomic<float>* drive     = nullptr;
+    std::atomic<float>* type      = nullptr;
+    std::atomic<float>* quality   = nullptr;
+
+    std::atomic<float>* oversampling        = nullptr;
+    std::atomic<float>* oversamplingFilter  = nullptr;
+    std::atomic<float>* offlineOversampling = nullptr;
+    std::atomic<float>* bypass              = nullptr;
+
+    std::atomic<float>* voiceBank = nullptr;
+    std::atomic<float>* keytrack  = nullptr;
+    std::atomic<float>* velocity  = nullptr;
+
+    std::atomic<float>* sidechainCutoff    = nullptr;
+    std::atomic<float>* sidechainResonance = nullptr;
+
+    std::atomic<float>* morph       = nullptr;
+    std::atomic<float>* morphTarget = nullptr;
+
+    std::atomic<juce::uint32> dirty { allDirty };
+
+    Watcher watchers[16] { { "CUTOFF",       cutoffDirty },
+                          { "RESONANCE",    resonanceDirty },
+                          { "DRIVE",        driveDirty },
+                          { "TYPE",         typeDirty },
+                          { "QUALITY",      qualityDirty },
+                          { "OVERSAMPLING", oversamplingDirty },
+                          { "OS_FILTER",    oversamplingDirty },
+                          { "OFFLINE_OS",   oversamplingDirty },
+                          { "BYPASS",       bypassDirty },
+                          { "VOICES",       voicesDirty },
+                          { "KEYTRACK",     voicesDirty },
+                          { "VELOCITY",     voicesDirty },
+                          { "SC_CUTOFF",    sidechainDirty },
+                          { "SC_RESONANCE", sidechainDirty },
+                          { "MORPH",        morphDirty },
+                          { "MORPH_TARGET", morphDirty } };
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterSnapshot)
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 0 to compile the instrumentation out of processBlock altogether
+#ifndef LADDER_INSTRUMENTATION
+ #define LADDER_INSTRUMENTATION 1
+#endif
+
+//==============================================================================
+/** Timing of the last PerformanceMonitor::windowSize blocks, as published to other threads. */
+struct PerformanceStats
+{
+    double minMicros = 0.0;
+    double avgMicros = 0.0;
+    double p99Micros = 0.0;
+    double maxMicros = 0.0;
+
+    double deadlineShare     = 0.0;     // processing time over buffer duration, across the window
+    double peakDeadlineShare = 0.0;     // worst single block
+
+    juce::uint64 numBlocks = 0;              // timed since prepare
+    juce::uint64 coefficientUpdates = 0;     // ladder coefficient recomputations since prepare
+};
+
+//==============================================================================
+/**
+    Times processBlock and publishes rolling statistics without locks.
+
+    The audio thread keeps the last windowSize block times to itself and every
+    publishInterval blocks writes the summary through a seqlock, so readers on
+    the message thread or in a test never block it; they just retry if they
+    caught a write half way.
+
+    Monitoring starts disabled. While disabled a block costs one relaxed atomic
+    load, and with LADDER_INSTRUMENTATION set to 0 nothing at all.
+*/
+class PerformanceMonitor
+{
+public:
+    static constexpr int windowSize = 256;
+    static constexpr int publishInterval = 16;
+
+    /** Clears the window and the published stats. Not realtime safe. */
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        numWritten = 0;
+        numBlocks = 0;
+        coefficientUpdates = 0;
+        write (PerformanceStats {});
+    }
+
+    void setEnabled (bool shouldBeEnabled) noexcept     { enabled.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept                     { return enabled.load (std::memory_order_relaxed); }
+
+    /** Returns the latest published stats. Safe from any thread. */
+    PerformanceStats getStats() const noexcept
+    {
+        for (;;)
+        {
+            const auto before = sequence.load (std::memory_order_acquire);
+
+            if ((before & 1) == 0)
+            {
+                PerformanceStats s;
+                s.minMicros          = published.minMicros.load (std::memory_order_relaxed);
+                s.avgMicros          = published.avgMicros.load (std::memory_order_relaxed);
+                s.p99Micros          = published.p99Micros.load (std::memory_order_relaxed);
+                s.maxMicros          = published.maxMicros.load (std::memory_order_relaxed);
+                s.deadlineShare      = published.deadlineShare.load (std::memory_order_relaxed);
+                s.peakDeadlineShare  = published.peakDeadlineShare.load (std::memory_order_relaxed);
+                s.numBlocks          = published.numBlocks.load (std::memory_order_relaxed);
+                s.coefficientUpdates = published.coefficientUpdates.load (std::memory_order_relaxed);
+
+                std::atomic_thread_fence (std::memory_order_acquire);
+
+                if (sequence.load (std::memory_order_relaxed) == before)
+                    return s;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    //==============================================================================
+    /** Times the enclosing scope as one block of numSamples, and counts how far coefficientCounter moved in it. */
+    class ScopedBlockTimer
+    {
+    public:
+       #if LADDER_INSTRUMENTATION
+        ScopedBlockTimer (PerformanceMonitor& m, int numSamples, const juce::uint64& coefficientCounter) noexcept
+            : monitor (m.isEnabled() ? &m : nullptr), blockSize (numSamples),
+              coefficients (coefficientCounter), coefficientsAtStart (coefficientCounter),
+              start (monitor != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedBlockTimer()
+        {
+            if (monitor != nullptr)
+                monitor->addBlock (juce::Time::getHighResolutionTicks() - start, blockSize, coefficients - coefficientsAtStart);
+        }
+
+    private:
+        PerformanceMonitor* const monitor;
+        const int blockSize;
+        const juce::uint64& coefficients;
+        const juce::uint64 coefficientsAtStart;
+        const juce::int64 start;
+       #else
+        ScopedBlockTimer (PerformanceMonitor&, int, const juce::uint64&) noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlockTimer)
+    };
+
+private:
+    //==============================================================================
+    struct BlockTime
+    {
+        float micros;
+        float deadlineShare;
+    };
+
+    void addBlock (juce::int64 ticks, int numSamples, juce::uint64 blockCoefficientUpdates) noexcept
+    {
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (ticks);
+        const auto deadline = numSamples / sampleRate;
+
+        window[numBlocks % windowSize] = { (float) (seconds * 1.0e6), deadline > 0.0 ? (float) (seconds / deadline) : 0.0f };
+        ++numBlocks;
+        coefficientUpdates += blockCoefficientUpdates;
+        numWritten = juce::jmin (numWritten + 1, windowSize);
+
+        if (numBlocks % publishInterval == 0)
+            publish();
+    }
+
+    void publish() noexcept
+    {
+        PerformanceStats s;
+        double sumMicros = 0.0, sumShares = 0.0;
+        s.minMicros = std::numeric_limits<double>::max();
+
+        for (int i = 0; i < numWritten; ++i)
+        {
+            const auto& b = window[i];
+            sorted[i] = b.micros;
+            sumMicros += b.micros;
+            sumShares += b.deadlineShare;
+            s.minMicros = juce::jmin (s.minMicros, (double) b.micros);
+            s.maxMicros = juce::jmax (s.maxMicros, (double) b.micros);
+            s.peakDeadlineShare = juce::jmax (s.peakDeadlineShare, (double) b.deadlineShare);
+        }
+
+        const auto p99Index = (numWritten - 1) * 99 / 100;
+        std::nth_element (sorted, sorted + p99Index, sorted + numWritten);
+
+        s.avgMicros = sumMicros / numWritten;
+        s.p99Micros = sorted[p99Index];
+        s.deadlineShare = sumShares / numWritten;
+        s.numBlocks = numBlocks;
+        s.coefficientUpdates = coefficientUpdates;
+        write (s);
+    }
+
+    void write (const PerformanceStats& s) noexcept
+    {
+        const auto seq = sequence.load (std::memory_order_relaxed);
+        sequence.store (seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        published.minMicros.store (s.minMicros, std::memory_order_relaxed);
+        published.avgMicros.store (s.avgMicros, std::memory_order_relaxed);
+        published.p99Micros.store (s.p99Micros, std::memory_order_relaxed);
+        published.maxMicros.store (s.maxMicros, std::memory_order_relaxed);
+        published.deadlineShare.store (s.deadlineShare, std::memory_order_relaxed);
+        published.peakDeadlineShare.store (s.peakDeadlineShare, std::memory_order_relaxed);
+        published.numBlocks.store (s.numBlocks, std::memory_order_relaxed);
+        published.coefficientUpdates.store (s.coefficientUpdates, std::memory_order_relaxed);
+
+        sequence.store (seq + 2, std::memory_order_release);
+    }
+
+    //==============================================================================
+    std::atomic<bool> enabled { false };
+    double sampleRate = 44100.0;
+
+    // Audio thread only
+    BlockTime window[windowSize] {};
+    float sorted[windowSize] {};
+    int numWritten = 0;
+    juce::uint64 numBlocks = 0, coefficientUpdates = 0;
+
+    // Published through the seqlock; the fields are atomics so a torn read is retried, not undefined
+    struct
+    {
+        std::atomic<double> minMicros { 0.0 }, avgMicros { 0.0 }, p99Micros { 0.0 }, maxMicros { 0.0 };
+        std::atomic<double> deadlineShare { 0.0 }, peakDeadlineShare { 0.0 };
+        std::atomic<juce::uint64> numBlocks { 0 }, coefficientUpdates { 0 };
+    } published;
+
+    std::atomic<juce::uint32> sequence { 0 };
+};
@@ -11,7 +11,7 @@
 
 //==============================================================================
 LadderFilterBasicAudioProcessorEditor::LadderFilterBasicAudioProcessorEditor (LadderFilterBasicAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), spectrumAnalyser (p), responseCurve (p), audioProcessor (p)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -26,7 +26,6 @@ LadderFilterBasicAudioProcessorEditor::LadderFilterBasicAudioProcessorEditor (La
     for(int i = 0; i < 6; i++)
         filterTypeMenu.addItem(p.filterTypes[i], i+1);
     
-    filterTypeMenu.onChange = [this] { modeMenuChanged(); };
     filterTypeMenu.setSelectedId (1);
     
     labelFilterType.attachToComponent(&filterTypeMenu, false);
@@ -62,11 +61,32 @@ LadderFilterBasicAudioProcessorEditor::LadderFilterBasicAudioProcessorEditor (La
     sliderAttachmentDrive = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "DRIVE", sliderDrive);
     
     comboAttachmentFilterType = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "TYPE", filterTypeMenu);
+    
+    addAndMakeVisible(loadMeter);
+    addAndMakeVisible(spectrumAnalyser);
+    addAndMakeVisible(responseCurve);
+    
+    //Only time processBlock while someone is looking. One timer drives every repaint, so
+    //several open editors cost a few small repaints a second, not a paint per parameter move
+    audioProcessor.setInstrumentationEnabled(true);
+    startTimerHz(15);
 
 }
 
 LadderFilterBasicAudioProcessorEditor::~LadderFilterBasicAudioProcessorEditor()
 {
+    stopTimer();
+    audioProcessor.setInstrumentationEnabled(false);
+}
+
+void LadderFilterBasicAudioProcessorEditor::timerCallback()
+{
+    const auto sampleRate = audioProcessor.getSampleRate();
+    const auto latencyMs = sampleRate > 0.0 ? audioProcessor.getLatencySamples() * 1000.0 / sampleRate : 0.0;
+    
+    loadMeter.update(audioProcessor.getPerformanceStats(), latencyMs);
+    spectrumAnalyser.refresh();
+    responseCurve.refresh();
 }
 
 //==============================================================================
@@ -85,35 +105,7 @@ void LadderFilterBasicAudioProcessorEditor::resized()
     sliderReson.setBounds(getWidth()/2-50, getHeight()/2, 75, 200);
     sliderDrive.setBounds(getWidth()/2+50, getHeight()/2, 75, 200);
     filterTypeMenu.setBounds(getWidth()/2 - 75, getHeight() - 350, 100, 25);
-}
-
-void LadderFilterBasicAudioProcessorEditor::modeMenuChanged()
-{
-    //{"LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24"}
-    switch (filterTypeMenu.getSelectedId())
-    {
-        case 1:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::LPF12;
-            break;
-        case 2:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::HPF12;
-            break;
-        case 3:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::BPF12;
-            break;
-        case 4:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::LPF24;
-            break;
-        case 5:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::HPF24;
-            break;
-        case 6:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::BPF24;
-            break;
-            
-        default:
-            audioProcessor.filterMode = juce::dsp::LadderFilterMode::LPF12;
-            break;
-    }
-
+    loadMeter.setBounds(10, 2, getWidth() - 20, 18);
+    spectrumAnalyser.setBounds(10, 80, getWidth() - 20, 80);
+    responseCurve.setBounds(spectrumAnalyser.getBounds());
 }
@@ -10,12 +10,15 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "LoadMeter.h"
+#include "ResponseCurve.h"
+#include "SpectrumAnalyser.h"
 #include <string>
 
 //==============================================================================
 /**
 */
-class LadderFilterBasicAudioProcessorEditor  : public juce::AudioProcessorEditor
+class LadderFilterBasicAudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
 {
 public:
     LadderFilterBasicAudioProcessorEditor (LadderFilterBasicAudioProcessor&);
@@ -25,9 +28,9 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
     
-    void modeMenuChanged();
-    
 private:
+    void timerCallback() override;
+    
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     juce::Slider sliderCutoff;
@@ -43,6 +46,10 @@ private:
     juce::Font textFont   { 12.0f };
     juce::ComboBox filterTypeMenu;
     
+    LoadMeter loadMeter; //processBlock load and latency
+    SpectrumAnalyser spectrumAnalyser; //Pre/post spectra behind the response curve
+    ResponseCurve responseCurve; //Drawn off the message thread, swapped in by the timer
+    
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachmentCutoff;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachmentReson;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachmentDrive;
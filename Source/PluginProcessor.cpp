@@ -16,6 +16,7 @@ LadderFilterBasicAudioProcessor::LadderFilterBasicAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -23,6 +24,8 @@ LadderFilterBasicAudioProcessor::LadderFilterBasicAudioProcessor()
 #endif
 {
     apvts.state.addListener(this);
+    parameters.attachTo(apvts);
+    compactState.attachTo(apvts);
     
 }
 
@@ -38,6 +41,7 @@ const juce::String LadderFilterBasicAudioProcessor::getName() const
 
 bool LadderFilterBasicAudioProcessor::acceptsMidi() const
 {
+    //For the voice bank. The AU stays an aufx effect, so hosts that keep MIDI from effects leave it silent
    #if JucePlugin_WantsMidiInput
     return true;
    #else
@@ -65,41 +69,125 @@ bool LadderFilterBasicAudioProcessor::isMidiEffect() const
 
 double LadderFilterBasicAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    //The ladder rings longer the higher the resonance and the lower the cutoff
+    const auto params = getMorphedParameterValues();
+    return LadderEngine<float>::getTailLengthSamples(params.cutoff, params.resonance, params.drive, baseSampleRate)
+         / baseSampleRate;
 }
 
 int LadderFilterBasicAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return PresetBank::numPrograms;
 }
 
 int LadderFilterBasicAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load(std::memory_order_relaxed);
 }
 
 void LadderFilterBasicAudioProcessor::setCurrentProgram (int index)
 {
+    if (! juce::isPositiveAndBelow(index, PresetBank::numPrograms))
+        return;
+    
+    //Lock-free from any thread: the whole program is swapped in at the start of the next block
+    currentProgram.store(index, std::memory_order_relaxed);
+    programRequests.fetch_add(1, std::memory_order_release);
+    pendingProgram.store(&PresetBank::get(index), std::memory_order_release);
+    
+    //The parameters follow on the message thread so the host and the editor show the program;
+    //called from there they are written straight away, with no wait for the message loop
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        writeProgramParameters();
+    else
+        triggerAsyncUpdate();
 }
 
 const juce::String LadderFilterBasicAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return PresetBank::get(index).name;
 }
 
 void LadderFilterBasicAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    //Factory programs are fixed
+    juce::ignoreUnused(index, newName);
+}
+
+void LadderFilterBasicAudioProcessor::handleAsyncUpdate()
+{
+    //Oversampling stages asked for on the audio thread are built here, then picked up at its next block
+    if (floatChain.oversampling.isBuildPending() || doubleChain.oversampling.isBuildPending())
+    {
+        floatChain.oversampling.build();
+        doubleChain.oversampling.build();
+        parameters.markDirty(ParameterSnapshot::oversamplingDirty);
+    }
+    
+    //Latency changes picked up on the audio thread are reported from here, as hosts expect
+    setLatencySamples(oversamplingLatency.load(std::memory_order_relaxed));
+    writeProgramParameters();
+}
+
+void LadderFilterBasicAudioProcessor::writeProgramParameters()
+{
+    //Only write the program's parameters if a program change is still waiting for them
+    const auto request = programRequests.load(std::memory_order_acquire);
+    if (request == programWritten.load(std::memory_order_acquire))
+        return;
+    
+    const auto& program = PresetBank::get(currentProgram.load(std::memory_order_relaxed));
+    
+    const std::pair<const char*, float> values[] { { "CUTOFF", program.cutoff }, { "RESONANCE", program.resonance },
+                                                    { "DRIVE", program.drive }, { "TYPE", (float) program.type } };
+    
+    for (auto& [parameterID, value] : values)
+        if (auto* parameter = apvts.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    
+    programWritten.store(request, std::memory_order_release);
+}
+
+void LadderFilterBasicAudioProcessor::applyPendingProgram() noexcept
+{
+    constexpr auto soundFlags = ParameterSnapshot::cutoffDirty | ParameterSnapshot::resonanceDirty
+                              | ParameterSnapshot::driveDirty | ParameterSnapshot::typeDirty;
+    
+    //A program lands whole at the block boundary; the engine ramps the coefficients over, so it doesn't click
+    if (auto* program = pendingProgram.exchange(nullptr, std::memory_order_acquire))
+    {
+        landingProgram = program;
+        landingRequest = programRequests.load(std::memory_order_acquire);
+        programGlide = true;
+        parameters.markDirty(soundFlags);
+    }
+    //The parameters take over again once they hold the program's values, or once the program has
+    //been written to them and a move made since then should win; until then the program stands in
+    else if (landingProgram != nullptr)
+    {
+        if (programWritten.load(std::memory_order_acquire) == landingRequest
+            || PresetBank::matches(*landingProgram, parameters.load()))
+        {
+            landingProgram = nullptr;
+            parameters.markDirty(soundFlags);
+        }
+    }
 }
 
 //==============================================================================
 void LadderFilterBasicAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     
-    cutoffFreq = apvts.getRawParameterValue("CUTOFF")->load();
-    res = apvts.getRawParameterValue("RESONANCE")->load();
-    drive = apvts.getRawParameterValue("DRIVE")->load();
-    filterMode = juce::dsp::LadderFilterMode::LPF12;
+    //Clear the dirty flags before reading so a change made after this point is not lost
+    parameters.takeDirtyFlags();
+    const auto params = parameters.load();
+    const auto sound = PresetBank::morph(params);
+    cutoffFreq = sound.cutoff;
+    res = sound.resonance;
+    drive = sound.drive;
+    filterMode = modeForIndex(sound.type);
+    sidechainDepths[0].setCurrentAndTargetValue(params.sidechainCutoff);
+    sidechainDepths[1].setCurrentAndTargetValue(params.sidechainResonance);
     
     
     juce::dsp::ProcessSpec spec;
@@ -107,12 +195,89 @@ void LadderFilterBasicAudioProcessor::prepareToPlay (double sampleRate, int samp
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
     
-    Filter.prepare(spec);
-    Filter.setEnabled(true);
-    Filter.setMode(filterMode);
-    Filter.setCutoffFrequencyHz(cutoffFreq);
-    Filter.setResonance(res);
-    Filter.setDrive(drive);
+    baseSampleRate = sampleRate;
+    bypassMix.reset(sampleRate, 0.01);
+    bypassMix.setCurrentAndTargetValue(params.bypass ? 1.0f : 0.0f);
+    sleeping = false;
+    silentSamples = 0;
+    tailStale = true;
+    monitor.prepare(sampleRate);
+    spectrumTap.prepare(samplesPerBlock);
+    
+    //The host sets the precision before calling this, and has to call it again to change it
+    if (getProcessingPrecision() == doublePrecision)
+    {
+        prepareChain(doubleChain, spec, params);
+        releaseChain(floatChain);
+    }
+    else
+    {
+        prepareChain(floatChain, spec, params);
+        releaseChain(doubleChain);
+    }
+    
+    setLatencySamples(oversamplingLatency.load(std::memory_order_relaxed));
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::prepareChain (Chain<SampleType>& chain, const juce::dsp::ProcessSpec& spec,
+                                                    const LadderParameters& params)
+{
+    //The engine crossfades mode changes itself, so one ladder covers every channel
+    chain.filter.prepare(spec);
+    chain.filter.setMode(filterMode);
+    chain.filter.setCutoffFrequencyHz((SampleType) cutoffFreq);
+    chain.filter.setResonance((SampleType) res);
+    chain.filter.setDrive((SampleType) drive);
+    chain.filter.setSaturation(kernelForQuality(params.quality));
+    chain.filter.reset();
+    
+    //The voice bank follows the same settings, plus MIDI keytracking
+    useVoiceBank = params.voiceBank;
+    chain.voices.prepare(spec);
+    chain.voices.setMode(filterMode);
+    chain.voices.setCutoffFrequencyHz((SampleType) cutoffFreq);
+    chain.voices.setResonance((SampleType) res);
+    chain.voices.setDrive((SampleType) drive);
+    chain.voices.setSaturation(kernelForQuality(params.quality));
+    chain.voices.setKeytracking((SampleType) params.keytrack);
+    chain.voices.setVelocitySensitivity((SampleType) params.velocity);
+    chain.voices.resetState();
+    
+    //Only the oversampling stage in use is built, below; others follow on the message thread when asked for
+    chain.oversampling.prepare((int) spec.numChannels, (int) spec.maximumBlockSize);
+    
+    //The dry path for the bypass crossfade is delayed by the oversampling latency
+    chain.dryBuffer.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+    chain.dryDelay.setMaximumDelayInSamples(juce::jmax(1, chain.oversampling.getMaxLatencyInSamples()));
+    chain.dryDelay.prepare(spec);
+    
+    //Room for the sidechain streams at the highest oversampling factor
+    chain.modulation.setSize(2, (int) spec.maximumBlockSize << OversamplingStage<SampleType>::maxOrder);
+    chain.lastModulation[0] = chain.lastModulation[1] = 0;
+    
+    updateOversampling(chain, params, true);
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::releaseChain (Chain<SampleType>& chain)
+{
+    //Only one precision runs at a time, so the other chain gives its buffers back
+    chain.oversampling.release();
+    chain.dryBuffer.setSize(0, 0);
+    chain.modulation.setSize(0, 0);
+}
+
+template <>
+LadderFilterBasicAudioProcessor::Chain<float>& LadderFilterBasicAudioProcessor::getChain<float>() noexcept
+{
+    return floatChain;
+}
+
+template <>
+LadderFilterBasicAudioProcessor::Chain<double>& LadderFilterBasicAudioProcessor::getChain<double>() noexcept
+{
+    return doubleChain;
 }
 
 void LadderFilterBasicAudioProcessor::releaseResources()
@@ -128,18 +293,29 @@ bool LadderFilterBasicAudioProcessor::isBusesLayoutSupported (const BusesLayout&
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any discrete or surround layout up to maxNumChannels is fine: the
+    // ladder engine runs the channels in SIMD-width groups, so one instance
+    // can cover a whole 7.1.4 or ambisonic bed.
+    const auto numOutputChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numOutputChannels < 1 || numOutputChannels > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain is optional: mono modulates cutoff and resonance together,
+    // stereo sends the left channel to cutoff and the right to resonance
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+
+        if (! sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono()
+                                     && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -149,8 +325,33 @@ bool LadderFilterBasicAudioProcessor::isBusesLayoutSupported (const BusesLayout&
 
 void LadderFilterBasicAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
+    processSamples(buffer, midiMessages);
+}
+
+void LadderFilterBasicAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, midiMessages);
+}
+
+bool LadderFilterBasicAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    //Both chains share the templated ladder, so a 64-bit host is filtered in double end to end
+    return true;
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi)
+{
+    auto& chain = getChain<SampleType>();
+    
+   #if LADDER_FLUSH_DENORMALS
+    std::optional<juce::ScopedNoDenormals> noDenormals;
+    if (chain.oversampling.getFactor() > 1)
+        noDenormals.emplace();
+   #endif
+    
+    PerformanceMonitor::ScopedBlockTimer blockTimer (monitor, buffer.getNumSamples(), chain.filter.getCoefficientUpdateCounter());
+    auto totalNumInputChannels  = getMainBusNumInputChannels(); //The sidechain comes after these
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     // In case we have more outputs than inputs, this code clears any output
@@ -162,26 +363,447 @@ void LadderFilterBasicAudioProcessor::processBlock (juce::AudioBuffer<float>& bu
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    juce::dsp::AudioBlock<float> block (buffer);
+    auto block = getMainBlock(buffer);
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= (size_t) chain.dryBuffer.getNumSamples());
+    
+    //Offline renders may use a higher oversampling factor than realtime playback
+    if (isNonRealtime() != renderingOffline)
+        parameters.markDirty(ParameterSnapshot::oversamplingDirty);
+    
+    applyPendingProgram();
+    applyParameterChanges(chain, (int) numSamples);
+    
+    //Feed the analyser, only while an editor is showing it
+    const auto tapActive = spectrumTap.isActive();
+    if (tapActive)
+        spectrumTap.push(SpectrumTap::pre, block);
+    
+    //Count silence before anything else, so it stays tracked through bypass as well
+    const auto inputRange = block.findMinAndMax();
+    const auto inputSilent = juce::jmax(-inputRange.getStart(), inputRange.getEnd()) <= (SampleType) silenceThreshold;
+    silentSamples = inputSilent ? silentSamples + (juce::int64) numSamples : 0;
+    
+    //Keep the dry path running while bypass can be heard, and always when it carries latency
+    const auto latency = chain.oversampling.getLatencyInSamples();
+    const auto bypassAudible = bypassMix.isSmoothing() || bypassMix.getTargetValue() > 0.0f;
+    if (bypassAudible || latency > 0)
+        processDry(chain, block);
     
-    //Check and set cutoff
-    float cutoffFreqNew = apvts.getRawParameterValue("CUTOFF")->load();
-    if(cutoffFreq != cutoffFreqNew)
-        Filter.setCutoffFrequencyHz(cutoffFreqNew);
+    //Fully bypassed, the ladder sleeps and is reset when it comes back
+    if (! bypassMix.isSmoothing() && bypassMix.getTargetValue() >= 1.0f)
+    {
+        block.copyFrom(chain.dryBuffer, 0, 0, numSamples);
+        sleeping = true;
+        
+        if (useVoiceBank)
+            chain.voices.handleMidi(midi);
+        
+        if (tapActive)
+            spectrumTap.push(SpectrumTap::post, block);
+        
+        return;
+    }
     
-    //Check and set resonance
-    float resNew = apvts.getRawParameterValue("RESONANCE")->load();
-    if(res != resNew)
-        Filter.setResonance(resNew);
+    //Skip the ladder entirely while the input is silent and the tail has rung out; coming
+    //out of bypass, only once the dry delay has no more of the input to play
+    if (sleeping)
+    {
+        if (inputSilent && silentSamples > latency)
+        {
+            block.clear();
+            bypassMix.skip((int) numSamples);
+            
+            //Notes still come and go while asleep, so no voice is left hanging
+            if (useVoiceBank)
+                chain.voices.handleMidi(midi);
+            
+            if (tapActive)
+                spectrumTap.push(SpectrumTap::post, block);
+            
+            return;
+        }
+        
+        wakeUp(chain);
+    }
     
-    //Check and set drive
-    float driveNew = apvts.getRawParameterValue("DRIVE")->load();
-    if(drive != driveNew)
-        Filter.setDrive(driveNew);
+    const auto modulated = prepareModulation(chain, buffer);
     
-    Filter.setMode(filterMode);
+    chain.oversampling.process(block, [&] (juce::dsp::AudioBlock<SampleType>& oversampledBlock)
+    {
+        if (useVoiceBank)
+        {
+            chain.voices.process(oversampledBlock, midi, 0, chain.oversampling.getFactor());
+            return;
+        }
+        
+        if (modulated)
+            chain.filter.setModulation(chain.modulation.getReadPointer(0), chain.modulation.getReadPointer(1));
+        
+        chain.filter.process(juce::dsp::ProcessContextReplacing<SampleType> (oversampledBlock));
+    });
     
-    Filter.process(juce::dsp::ProcessContextReplacing<float> (block));
+    //Soft bypass, crossfade towards the dry signal
+    if (bypassAudible)
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto mix = (SampleType) bypassMix.getNextValue();
+            
+            for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            {
+                auto& out = block.getChannelPointer(ch)[i];
+                out += (chain.dryBuffer.getSample((int) ch, (int) i) - out) * mix;
+            }
+        }
+    }
+    
+    if (tapActive)
+        spectrumTap.push(SpectrumTap::post, block);
+    
+    //Sleep once the dry delay and the oversampling filters have flushed (up to the latency each),
+    //the ladder has had its tail to ring out, and nothing above the threshold is left
+    const auto decayed = useVoiceBank ? chain.voices.hasDecayed((SampleType) silenceThreshold)
+                                      : chain.filter.hasDecayed((SampleType) silenceThreshold);
+    
+    if (inputSilent && decayed && silentSamples > 2 * latency)
+    {
+        //The root solve is only worth doing when sleep is close, and again only after a sound change
+        if (tailStale)
+        {
+            tailSamples = (juce::int64) LadderEngine<double>::getTailLengthSamples(cutoffFreq, res, drive, baseSampleRate);
+            tailStale = false;
+        }
+        
+        if (silentSamples > 2 * latency + tailSamples)
+        {
+            const auto outputRange = block.findMinAndMax();
+            sleeping = juce::jmax(-outputRange.getStart(), outputRange.getEnd()) <= (SampleType) silenceThreshold;
+        }
+    }
+}
+
+void LadderFilterBasicAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBypassed(buffer, midiMessages);
+}
+
+void LadderFilterBasicAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBypassed(buffer, midiMessages);
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::processBypassed (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi)
+{
+    //Host bypass without the parameter: pass the input through the same latency as processBlock
+    auto& chain = getChain<SampleType>();
+    auto block = getMainBlock(buffer);
+    processDry(chain, block);
+    
+    block.copyFrom(chain.dryBuffer, 0, 0, block.getNumSamples());
+    sleeping = true;
+    silentSamples = 0; //Silence isn't counted here, so the dry delay has to be seen to empty again
+    
+    if (useVoiceBank)
+        chain.voices.handleMidi(midi);
+}
+
+juce::AudioProcessorParameter* LadderFilterBasicAudioProcessor::getBypassParameter() const
+{
+    return apvts.getParameter("BYPASS");
+}
+
+template <typename SampleType>
+juce::dsp::AudioBlock<SampleType> LadderFilterBasicAudioProcessor::getMainBlock (juce::AudioBuffer<SampleType>& buffer) const
+{
+    //Processing is in place on the main bus; any sidechain channels follow it in the buffer
+    return juce::dsp::AudioBlock<SampleType> (buffer).getSubsetChannelBlock(0, (size_t) getMainBusNumOutputChannels());
+}
+
+template <typename SampleType>
+bool LadderFilterBasicAudioProcessor::prepareModulation (Chain<SampleType>& chain, juce::AudioBuffer<SampleType>& buffer)
+{
+    //Returns true when the sidechain moves inside the block, so the ladder needs per sample coefficients
+    const auto* bus = getBus(true, 1);
+    
+    auto& cutoffDepth = sidechainDepths[0];
+    auto& resonanceDepth = sidechainDepths[1];
+    const auto depthsMoving = cutoffDepth.isSmoothing() || resonanceDepth.isSmoothing();
+    
+    if (bus == nullptr || ! bus->isEnabled() || (! depthsMoving && cutoffDepth.getTargetValue() == 0.0f
+                                                                 && resonanceDepth.getTargetValue() == 0.0f))
+    {
+        for (auto& depth : sidechainDepths)
+            depth.setCurrentAndTargetValue(depth.getTargetValue());
+        
+        chain.filter.setModulation((SampleType) 0, (SampleType) 0);
+        chain.lastModulation[0] = chain.lastModulation[1] = 0;
+        return false;
+    }
+    
+    const auto sidechain = getBusBuffer(buffer, true, 1);
+    const auto numSamples = sidechain.getNumSamples();
+    const SampleType depths[] { (SampleType) cutoffDepth.getCurrentValue(), (SampleType) resonanceDepth.getCurrentValue() };
+    const SampleType* sources[] { sidechain.getReadPointer(0), sidechain.getReadPointer(sidechain.getNumChannels() - 1) };
+    
+    //A sidechain that holds still (a gate, a held CV, silence) under steady depths is folded into
+    //the control-rate coefficients
+    const auto cutoffRange = juce::FloatVectorOperations::findMinAndMax(sources[0], numSamples);
+    const auto resonanceRange = juce::FloatVectorOperations::findMinAndMax(sources[1], numSamples);
+    
+    if (! depthsMoving && cutoffRange.isEmpty() && resonanceRange.isEmpty())
+    {
+        chain.lastModulation[0] = cutoffRange.getStart() * depths[0];
+        chain.lastModulation[1] = resonanceRange.getStart() * depths[1];
+        chain.filter.setModulation(chain.lastModulation[0], chain.lastModulation[1]);
+        return false;
+    }
+    
+    //Otherwise build both streams at the ladder rate, ramping linearly between base rate samples
+    chain.filter.setModulation((SampleType) 0, (SampleType) 0);
+    const auto factor = chain.oversampling.getFactor();
+    const auto step = (SampleType) 1 / (SampleType) factor;
+    
+    for (int stream = 0; stream < 2; ++stream)
+    {
+        auto* out = chain.modulation.getWritePointer(stream);
+        auto previous = chain.lastModulation[stream];
+        auto& depth = sidechainDepths[stream];
+        const auto gliding = depth.isSmoothing();
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto target = sources[stream][i] * (gliding ? (SampleType) depth.getNextValue() : depths[stream]);
+            const auto delta = (target - previous) * step;
+            
+            for (int k = 1; k <= factor; ++k)
+                *out++ = previous + delta * (SampleType) k;
+            
+            previous = target;
+        }
+        
+        chain.lastModulation[stream] = previous;
+    }
+    
+    return true;
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::processDry (Chain<SampleType>& chain, const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto latency = chain.oversampling.getLatencyInSamples();
+    
+    for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+    {
+        const auto* in = block.getChannelPointer(ch);
+        auto* dry = chain.dryBuffer.getWritePointer((int) ch);
+        
+        if (latency == 0)
+        {
+            std::copy(in, in + block.getNumSamples(), dry);
+            continue;
+        }
+        
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            chain.dryDelay.pushSample((int) ch, in[i]);
+            dry[i] = chain.dryDelay.popSample((int) ch);
+        }
+    }
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::wakeUp (Chain<SampleType>& chain)
+{
+    //The state is below the threshold anyway; this also snaps the smoothers to moves made while asleep
+    chain.filter.reset();
+    chain.voices.resetState();
+    chain.oversampling.reset();
+    
+    for (auto& depth : sidechainDepths)
+        depth.setCurrentAndTargetValue(depth.getTargetValue());
+    
+    sleeping = false;
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::applyParameterChanges (Chain<SampleType>& chain, int numSamples)
+{
+    //Only touch the coefficients when a parameter listener flagged a change
+    if (const auto dirty = parameters.takeDirtyFlags())
+    {
+        auto params = parameters.load();
+        
+        //Hosts only move parameters between blocks, so a move glides across the block it arrives
+        //in and the next automation point is met on time; programs glide a little longer
+        const auto rampSeconds = programGlide ? programGlideSeconds
+                                              : juce::jmax(minimumRampSeconds, numSamples / baseSampleRate);
+        const auto rampLength = juce::roundToInt(rampSeconds * baseSampleRate * chain.oversampling.getFactor());
+        chain.filter.setRampLength(rampLength);
+        chain.voices.setRampLength(rampLength);
+        programGlide = false;
+        
+        if (landingProgram != nullptr)
+            PresetBank::apply(*landingProgram, params);
+        
+        //The morph moves all of the sound parameters, and is picked up at the control rate like them
+        const auto sound = PresetBank::morph(params);
+        const auto morphed = (dirty & ParameterSnapshot::morphDirty) != 0;
+        
+        //Check and set cutoff
+        if(((dirty & ParameterSnapshot::cutoffDirty) || morphed) && cutoffFreq != sound.cutoff)
+        {
+            cutoffFreq = sound.cutoff;
+            chain.filter.setCutoffFrequencyHz((SampleType) cutoffFreq);
+            chain.voices.setCutoffFrequencyHz((SampleType) cutoffFreq);
+            tailStale = true;
+            coefficientUpdates.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        //Check and set resonance
+        if(((dirty & ParameterSnapshot::resonanceDirty) || morphed) && res != sound.resonance)
+        {
+            res = sound.resonance;
+            chain.filter.setResonance((SampleType) res);
+            chain.voices.setResonance((SampleType) res);
+            tailStale = true;
+            coefficientUpdates.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        //Check and set drive
+        if(((dirty & ParameterSnapshot::driveDirty) || morphed) && drive != sound.drive)
+        {
+            drive = sound.drive;
+            chain.filter.setDrive((SampleType) drive);
+            chain.voices.setDrive((SampleType) drive);
+            tailStale = true;
+            coefficientUpdates.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        //Check and set mode, only on a real change; the engine crossfades the taps
+        if(((dirty & ParameterSnapshot::typeDirty) || morphed) && filterMode != modeForIndex(sound.type))
+        {
+            filterMode = modeForIndex(sound.type);
+            chain.filter.setMode(filterMode);
+            chain.voices.setMode(filterMode);
+        }
+        
+        if(dirty & ParameterSnapshot::qualityDirty)
+        {
+            chain.filter.setSaturation(kernelForQuality(params.quality));
+            chain.voices.setSaturation(kernelForQuality(params.quality));
+        }
+        
+        //Switching between the ladder and the voice bank starts the one coming in from silence
+        if(dirty & ParameterSnapshot::voicesDirty)
+        {
+            if (useVoiceBank != params.voiceBank)
+            {
+                useVoiceBank = params.voiceBank;
+                chain.filter.reset();
+                chain.voices.reset();
+            }
+            
+            chain.voices.setKeytracking((SampleType) params.keytrack);
+            chain.voices.setVelocitySensitivity((SampleType) params.velocity);
+        }
+        
+        if(dirty & ParameterSnapshot::sidechainDirty)
+        {
+            //The depths scale audio-rate modulation, so a step in one is a click; they glide with the rest
+            const auto depthSteps = juce::jmax(1, juce::roundToInt(rampSeconds * baseSampleRate));
+            const float targets[] { params.sidechainCutoff, params.sidechainResonance };
+            
+            for (int i = 0; i < 2; ++i)
+            {
+                const auto current = sidechainDepths[i].getCurrentValue();
+                sidechainDepths[i].reset(depthSteps);
+                sidechainDepths[i].setCurrentAndTargetValue(current);
+                sidechainDepths[i].setTargetValue(targets[i]);
+            }
+        }
+        
+        if(dirty & ParameterSnapshot::oversamplingDirty)
+            updateOversampling(chain, params);
+        
+        if(dirty & ParameterSnapshot::bypassDirty)
+            bypassMix.setTargetValue(params.bypass ? 1.0f : 0.0f);
+    }
+}
+
+template <typename SampleType>
+void LadderFilterBasicAudioProcessor::updateOversampling (Chain<SampleType>& chain, const LadderParameters& params,
+                                                          bool mayAllocate)
+{
+    renderingOffline = isNonRealtime();
+    
+    auto order = params.oversampling;
+    if (renderingOffline)
+        order = juce::jmax(order, params.offlineOversampling);
+    
+    const auto design = params.oversamplingFilter == 1 ? OversamplingStage<SampleType>::FilterDesign::linearPhase
+                                                       : OversamplingStage<SampleType>::FilterDesign::minimumPhase;
+    
+    auto changed = chain.oversampling.select(order, design);
+    
+    //A stage not built yet allocates, so while playing live the current factor carries on until the
+    //message thread has made it (handleAsyncUpdate); prepareToPlay and offline renders build it here
+    if (chain.oversampling.isBuildPending())
+    {
+        if (mayAllocate || renderingOffline)
+        {
+            chain.oversampling.build();
+            changed = chain.oversampling.select(order, design);
+        }
+        else
+        {
+            triggerAsyncUpdate();
+        }
+    }
+    
+    if (changed)
+    {
+        chain.filter.setSampleRate((SampleType) (baseSampleRate * chain.oversampling.getFactor()));
+        chain.voices.setSampleRate((SampleType) (baseSampleRate * chain.oversampling.getFactor()));
+    }
+    
+    //Keep the coefficient update period constant in time as the ladder rate changes
+    chain.filter.setControlInterval(coefficientInterval * chain.oversampling.getFactor());
+    chain.voices.setControlInterval(coefficientInterval * chain.oversampling.getFactor());
+    
+    const auto latency = chain.oversampling.getLatencyInSamples();
+    chain.dryDelay.setDelay((SampleType) latency);
+    
+    //setLatencySamples notifies the host synchronously, which many hosts don't allow from the
+    //audio thread; prepareToPlay reports it directly, changes made while playing go through handleAsyncUpdate
+    if (oversamplingLatency.exchange(latency, std::memory_order_relaxed) != latency)
+        triggerAsyncUpdate();
+}
+
+juce::dsp::LadderFilterMode LadderFilterBasicAudioProcessor::modeForIndex (int index)
+{
+    //{"LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24"}
+    switch (index)
+    {
+        case 1:  return juce::dsp::LadderFilterMode::HPF12;
+        case 2:  return juce::dsp::LadderFilterMode::BPF12;
+        case 3:  return juce::dsp::LadderFilterMode::LPF24;
+        case 4:  return juce::dsp::LadderFilterMode::HPF24;
+        case 5:  return juce::dsp::LadderFilterMode::BPF24;
+        default: return juce::dsp::LadderFilterMode::LPF12;
+    }
+}
+
+Saturation::Kernel LadderFilterBasicAudioProcessor::kernelForQuality (int index)
+{
+    //{"Standard", "High", "Eco"}, see Saturation.h for the error of each
+    switch (index)
+    {
+        case 1:  return Saturation::Kernel::pade;
+        case 2:  return Saturation::Kernel::polynomial;
+        default: return Saturation::Kernel::lookupTable;
+    }
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout LadderFilterBasicAudioProcessor::createParameters()
@@ -198,7 +820,39 @@ juce::AudioProcessorValueTreeState::ParameterLayout LadderFilterBasicAudioProces
     //auto attributes = juce::AudioParameterChoiceAttributes().withLabel ("selected");
     params.add(std::make_unique<juce::AudioParameterChoice>("TYPE", "Type",
                                                             juce::StringArray {"LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24"},
-                                                            1));
+                                                            0));
+    
+    //Saturation accuracy: lookup table (as JUCE's ladder), Pade approximant or clamped polynomial
+    params.add(std::make_unique<juce::AudioParameterChoice>("QUALITY", "Quality",
+                                                            juce::StringArray {"Standard", "High", "Eco"},
+                                                            0));
+    
+    //Oversampling around the ladder, factors are powers of two
+    params.add(std::make_unique<juce::AudioParameterChoice>("OVERSAMPLING", "Oversampling",
+                                                            juce::StringArray {"1x", "2x", "4x", "8x"},
+                                                            0));
+    params.add(std::make_unique<juce::AudioParameterChoice>("OS_FILTER", "Oversampling Filter",
+                                                            juce::StringArray {"Min Phase", "Linear Phase"},
+                                                            0));
+    params.add(std::make_unique<juce::AudioParameterChoice>("OFFLINE_OS", "Offline Oversampling",
+                                                            juce::StringArray {"Same", "2x", "4x", "8x"},
+                                                            0));
+    
+    //Host-visible bypass, crossfaded in processBlock
+    params.add(std::make_unique<juce::AudioParameterBool>("BYPASS", "Bypass", false));
+    
+    //Polyphonic voice bank: one ladder per held MIDI note, cutoff tracking the note and velocity
+    params.add(std::make_unique<juce::AudioParameterBool>("VOICES", "Voice Bank", false));
+    params.add(std::make_unique<juce::AudioParameterFloat>("KEYTRACK", "Keytracking", 0.0f, 1.0f, 1.0f));
+    params.add(std::make_unique<juce::AudioParameterFloat>("VELOCITY", "Velocity to Cutoff", 0.0f, 1.0f, 0.0f));
+    
+    //Sidechain input as audio-rate modulation of the single ladder: octaves of cutoff and resonance per unit of signal
+    params.add(std::make_unique<juce::AudioParameterFloat>("SC_CUTOFF", "Sidechain to Cutoff", -4.0f, 4.0f, 0.0f));
+    params.add(std::make_unique<juce::AudioParameterFloat>("SC_RESONANCE", "Sidechain to Resonance", -1.0f, 1.0f, 0.0f));
+    
+    //Continuous blend from the current settings towards one of the factory programs
+    params.add(std::make_unique<juce::AudioParameterFloat>("MORPH", "Morph", 0.0f, 1.0f, 0.0f));
+    params.add(std::make_unique<juce::AudioParameterChoice>("MORPH_TARGET", "Morph Target", PresetBank::getNames(), 0));
     
     return params;
 }
@@ -219,21 +873,21 @@ juce::AudioProcessorEditor* LadderFilterBasicAudioProcessor::createEditor()
 //==============================================================================
 void LadderFilterBasicAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    
-    
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    //Fixed binary layout straight from the parameter atomics, see CompactState.h
+    compactState.write(destData);
 }
 
 void LadderFilterBasicAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    //A restored state wins over a program change whose parameters haven't been written yet
+    pendingProgram.store(nullptr, std::memory_order_release);
+    programWritten.store(programRequests.load(std::memory_order_acquire), std::memory_order_release);
+    
+    //Current sessions are binary and skip the ValueTree entirely
+    if (compactState.read(data, sizeInBytes))
+        return;
     
+    //Sessions saved before the binary format are XML
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
@@ -9,12 +9,31 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+#include "CompactState.h"
+#include "PresetBank.h"
+#include "LadderEngine.h"
+#include "LadderVoiceBank.h"
+#include "OversamplingStage.h"
+#include "PerformanceMonitor.h"
+#include "SpectrumTap.h"
+
+// The ladders keep their state clear of subnormals themselves (Saturation::denormalGuard),
+// so flush-to-zero is only set for the oversampling filters around them. Switching the FPU
+// mode every block is cheap on x86 but not on ARM, where subnormals cost little anyway.
+#ifndef LADDER_FLUSH_DENORMALS
+ #if JUCE_ARM
+  #define LADDER_FLUSH_DENORMALS 0
+ #else
+  #define LADDER_FLUSH_DENORMALS 1
+ #endif
+#endif
 
 //==============================================================================
 /**
 */
-class LadderFilterBasicAudioProcessor  : public juce::AudioProcessor, public juce::dsp::LadderFilter<float>,
-                                         public juce::ValueTree::Listener
+class LadderFilterBasicAudioProcessor  : public juce::AudioProcessor, public juce::ValueTree::Listener,
+                                         private juce::AsyncUpdater
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -33,6 +52,11 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -62,11 +86,102 @@ public:
     float cutoffFreq;
     float res;
     float drive;
-    juce::dsp::LadderFilterMode filterMode;
+
+    /** Number of coefficient setter calls made from processBlock since construction. */
+    juce::uint64 getNumCoefficientUpdates() const noexcept { return coefficientUpdates.load(std::memory_order_relaxed); }
+
+    /** Current parameter values, read lock-free. Safe to call from any thread. */
+    LadderParameters getParameterValues() const noexcept { return parameters.load(); }
+    
+    /** As getParameterValues(), with the morph towards the target program applied: what the ladder plays. */
+    LadderParameters getMorphedParameterValues() const noexcept { return PresetBank::morph(parameters.load()); }
+    
+    /** Turns the processBlock timing on or off; off costs one atomic load per block. */
+    void setInstrumentationEnabled (bool shouldBeEnabled) noexcept { monitor.setEnabled(shouldBeEnabled); }
+    bool isInstrumentationEnabled() const noexcept { return monitor.isEnabled(); }
+    
+    /** Rolling processBlock timing, see PerformanceMonitor. Safe to call from any thread. */
+    PerformanceStats getPerformanceStats() const noexcept { return monitor.getStats(); }
+    
+    /** Pre and post filter audio for the spectrum analyser; see SpectrumTap. */
+    SpectrumTap& getSpectrumTap() noexcept { return spectrumTap; }
+    
+    /** True while processBlock is skipping the ladder because input and state are silent. */
+    bool isSleeping() const noexcept { return sleeping; }
+
+    /** Widest main bus isBusesLayoutSupported() accepts. */
+    static constexpr int maxNumChannels = 64;
+
     std::string filterTypes[6] = {"LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24"};
 
 private:
-    juce::dsp::LadderFilter<float> Filter;
+    /** Everything on the signal path, in one precision. Only the chain matching
+        getProcessingPrecision() is prepared, so the host's buffers are filtered
+        as they come with no conversion copies. */
+    template <typename SampleType>
+    struct Chain
+    {
+        LadderEngine<SampleType> filter;
+        LadderVoiceBank<SampleType> voices; //Used instead of filter while the voice bank is on
+        OversamplingStage<SampleType> oversampling;
+        juce::AudioBuffer<SampleType> dryBuffer;
+        juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> dryDelay; //Lines the dry signal up with the oversampling latency
+        juce::AudioBuffer<SampleType> modulation; //Sidechain cutoff (octaves) and resonance streams at the ladder rate
+        SampleType lastModulation[2] {};
+    };
+    
+    template <typename SampleType> Chain<SampleType>& getChain() noexcept;
+    template <typename SampleType> void prepareChain (Chain<SampleType>& chain, const juce::dsp::ProcessSpec& spec, const LadderParameters& params);
+    template <typename SampleType> static void releaseChain (Chain<SampleType>& chain);
+    template <typename SampleType> void processSamples (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi);
+    template <typename SampleType> void processBypassed (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi);
+    template <typename SampleType> void applyParameterChanges (Chain<SampleType>& chain, int numSamples);
+    template <typename SampleType> void updateOversampling (Chain<SampleType>& chain, const LadderParameters& params, bool mayAllocate = false);
+    template <typename SampleType> void processDry (Chain<SampleType>& chain, const juce::dsp::AudioBlock<SampleType>& block);
+    template <typename SampleType> void wakeUp (Chain<SampleType>& chain);
+    template <typename SampleType> bool prepareModulation (Chain<SampleType>& chain, juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType> juce::dsp::AudioBlock<SampleType> getMainBlock (juce::AudioBuffer<SampleType>& buffer) const;
+    void applyPendingProgram() noexcept;
+    void writeProgramParameters();
+    void handleAsyncUpdate() override;
+    static juce::dsp::LadderFilterMode modeForIndex (int index);
+    static Saturation::Kernel kernelForQuality (int index);
+    
+    Chain<float> floatChain;
+    Chain<double> doubleChain;
+    juce::dsp::LadderFilterMode filterMode = juce::dsp::LadderFilterMode::LPF12;
+    bool useVoiceBank = false;
+    juce::SmoothedValue<float> sidechainDepths[2]; //Cutoff octaves and resonance per unit of sidechain, glided like the sound parameters
+    
+    double baseSampleRate = 44100.0;
+    bool renderingOffline = false;
+    std::atomic<int> oversamplingLatency { 0 }; //Set wherever the factor changes, reported to the host on the message thread
+    
+    //Sleep and bypass
+    static constexpr float silenceThreshold = 1.0e-7f; //-140 dB, far above the denormal range
+    bool sleeping = false;
+    juce::int64 silentSamples = 0;
+    juce::int64 tailSamples = 0; //Ladder ring-out at the base rate, for the sleep check
+    bool tailStale = true;       //Set by sound changes, tailSamples is worked out again when needed
+    juce::SmoothedValue<float> bypassMix; //0 = filtered, 1 = dry
+    
+    PerformanceMonitor monitor;
+    SpectrumTap spectrumTap;
+    
+    ParameterSnapshot parameters; //Cached parameter pointers, resolved once
+    CompactState compactState; //Binary get/setStateInformation
+    
+    //Program changes: setCurrentProgram swaps the pointer, the audio thread picks it up at its next block
+    std::atomic<const Preset*> pendingProgram { nullptr };
+    std::atomic<int> currentProgram { 0 };
+    std::atomic<juce::uint32> programRequests { 0 }, programWritten { 0 };
+    const Preset* landingProgram = nullptr; //Stands in for the sound parameters until they have caught up
+    juce::uint32 landingRequest = 0;
+    std::atomic<juce::uint64> coefficientUpdates { 0 };
+    bool programGlide = false; //The next parameter change is a program landing
+    static constexpr double programGlideSeconds = 0.05;
+    static constexpr double minimumRampSeconds = 0.005; //Shortest ramp for a host or editor move
+    static constexpr int coefficientInterval = 16; //Ladder coefficient update period at the base rate, in samples
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters(); //Setup for APVTS
     
     
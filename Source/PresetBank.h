@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    Factory programs, kept in one flat constant array so a program change is
+    just a pointer to an entry; nothing is parsed or allocated when the host
+    switches. A program covers the sound of the ladder (cutoff, resonance,
+    drive and type) and leaves routing, quality and oversampling alone.
+
+    The morph control blends the current settings towards one of the
+    programs: cutoff geometrically, resonance and drive linearly, and the
+    type switches half way, where the engine crossfades the output taps.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+struct Preset
+{
+    const char* name;
+    float cutoff;
+    float resonance;
+    float drive;
+    int   type;     // index into LadderFilterBasicAudioProcessor::filterTypes
+};
+
+namespace PresetBank
+{
+    inline constexpr Preset programs[] =
+    {
+        { "Init",           2000.0f, 0.0f,  1.0f,  0 },
+        { "Warm Low Pass",   800.0f, 0.3f,  2.0f,  3 },
+        { "Acid Squelch",    400.0f, 0.7f,  4.0f,  3 },
+        { "Thin Air",       1500.0f, 0.1f,  1.0f,  1 },
+        { "Telephone",      1200.0f, 0.5f,  3.0f,  5 },
+        { "Sub Rumble",      120.0f, 0.2f,  1.5f,  3 },
+        { "Screamer",       2500.0f, 0.75f, 10.0f, 2 },
+        { "Dark Drive",      300.0f, 0.4f,  6.0f,  0 },
+    };
+
+    inline constexpr int numPrograms = (int) std::size (programs);
+
+    inline const Preset& get (int index) noexcept
+    {
+        return programs[juce::jlimit (0, numPrograms - 1, index)];
+    }
+
+    inline juce::StringArray getNames()
+    {
+        juce::StringArray names;
+
+        for (auto& program : programs)
+            names.add (program.name);
+
+        return names;
+    }
+
+    /** Replaces the sound parameters with the program's. */
+    inline void apply (const Preset& program, LadderParameters& params) noexcept
+    {
+        params.cutoff    = program.cutoff;
+        params.resonance = program.resonance;
+        params.drive     = program.drive;
+        params.type      = program.type;
+    }
+
+    /** True if params already hold the program's sound, allowing for the rounding of a
+        value written through a parameter's normalised range. */
+    inline bool matches (const Preset& program, const LadderParameters& params) noexcept
+    {
+        const auto near = [] (float value, float target) { return std::abs (value - target) <= 1.0e-4f * std::abs (target) + 1.0e-6f; };
+
+        return near (params.cutoff, program.cutoff) && near (params.resonance, program.resonance)
+            && near (params.drive, program.drive) && params.type == program.type;
+    }
+
+    /** The sound parameters after morphing params.morph of the way to the morph target. */
+    inline LadderParameters morph (LadderParameters params) noexcept
+    {
+        if (params.morph <= 0.0f)
+            return params;
+
+        const auto& target = get (params.morphTarget);
+        const auto amount = juce::jmin (params.morph, 1.0f);
+
+        params.cutoff    = params.cutoff * std::pow (target.cutoff / params.cutoff, amount);
+        params.resonance = params.resonance + (target.resonance - params.resonance) * amount;
+        params.drive     = params.drive + (target.drive - params.drive) * amount;
+        params.type      = amount < 0.5f ? params.type : target.type;
+        return params;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "EditorWorker.h"
+
+//==============================================================================
+/**
+    Magnitude response of the ladder for the current cutoff, resonance, drive
+    and mode.
+
+    The curve is worked out on a background thread shared by every open editor
+    and handed over as a finished juce::Path in unit coordinates; the message
+    thread only swaps it in and strokes it. The worker polls the parameters and
+    does nothing until one of them moves, and it never touches the audio thread.
+*/
+class ResponseCurve  : public juce::Component, private juce::TimeSliceClient
+{
+public:
+    explicit ResponseCurve (LadderFilterBasicAudioProcessor& p) : processor (p)
+    {
+        setOpaque (false);
+        worker->addTimeSliceClient (this);
+    }
+
+    ~ResponseCurve() override
+    {
+        worker->removeTimeSliceClient (this);
+    }
+
+    /** Call from a message thread timer; repaints only when the worker has finished a new curve. */
+    void refresh()
+    {
+        if (! curveReady.exchange (false, std::memory_order_acquire))
+            return;
+
+        {
+            const juce::SpinLock::ScopedLockType lock (curveLock);
+            std::swap (curve, pendingCurve);
+        }
+
+        repaint();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        // Drawn over the spectrum analyser, which fills the background
+        const auto bounds = getLocalBounds().toFloat();
+
+        // 0 dB line
+        g.setColour (juce::Colours::white.withAlpha (0.2f));
+        g.drawHorizontalLine (juce::roundToInt (bounds.getHeight() * dbToY (0.0)), 0.0f, bounds.getWidth());
+
+        g.setColour (juce::Colours::orange);
+        g.strokePath (curve, juce::PathStrokeType (1.5f),
+                      juce::AffineTransform::scale (bounds.getWidth(), bounds.getHeight()));
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numPoints = 256;
+    static constexpr double minFrequency = 20.0, maxFrequency = 20000.0;
+    static constexpr double minDb = -48.0, maxDb = 24.0;
+
+    static double dbToY (double db)
+    {
+        return 1.0 - (juce::jlimit (minDb, maxDb, db) - minDb) / (maxDb - minDb);
+    }
+
+    int useTimeSlice() override
+    {
+        static constexpr int pollIntervalMs = 30;
+
+        const auto params = processor.getMorphedParameterValues();
+        const auto sampleRate = processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 44100.0;
+
+        if (params.cutoff == drawn.cutoff && params.resonance == drawn.resonance
+             && params.drive == drawn.drive && params.type == drawn.type && sampleRate == drawnSampleRate)
+            return pollIntervalMs;
+
+        drawn = params;
+        drawnSampleRate = sampleRate;
+
+        const auto mode = (juce::dsp::LadderFilterMode) juce::jlimit (0, 5, params.type);
+        const auto nyquist = sampleRate * 0.5;
+        juce::Path path;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto x = (double) i / (numPoints - 1);
+            const auto frequency = juce::jmin (minFrequency * std::pow (maxFrequency / minFrequency, x), nyquist * 0.999);
+            const auto magnitude = LadderEngine<float>::getMagnitudeResponse (mode, params.cutoff, params.resonance,
+                                                                              params.drive, sampleRate, frequency);
+            const auto y = (float) dbToY (juce::Decibels::gainToDecibels (magnitude, minDb));
+
+            if (i == 0)
+                path.startNewSubPath ((float) x, y);
+            else
+                path.lineTo ((float) x, y);
+        }
+
+        {
+            const juce::SpinLock::ScopedLockType lock (curveLock);
+            std::swap (pendingCurve, path);
+        }
+
+        curveReady.store (true, std::memory_order_release);
+        return pollIntervalMs;
+    }
+
+    //==============================================================================
+    LadderFilterBasicAudioProcessor& processor;
+    juce::SharedResourcePointer<EditorWorker> worker;
+
+    // Worker thread only; the drawn type starts out of range so the first poll always draws
+    LadderParameters drawn { 0.0f, 0.0f, 0.0f, -1 };
+    double drawnSampleRate = 0.0;
+
+    juce::SpinLock curveLock;
+    juce::Path pendingCurve;            // guarded by curveLock
+    std::atomic<bool> curveReady { false };
+
+    juce::Path curve;                   // message thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResponseCurve)
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    tanh approximations for the ladder's saturation stages.
+
+    Every kernel is written once for plain scalars and for SIMDRegister, so the
+    ladder runs the same maths whichever layout it picked. Max absolute error
+    against std::tanh over the whole real line, measured in double precision:
+
+        lookupTable   6.0e-4   128 point table over [-5, 5], linear interpolation
+        pade          9.6e-5   [7/6] Pade approximant, input clamped to +-4.97
+        polynomial    1.9e-2   odd 9th order fit with tanh's unit slope at zero, so
+                               small signals pass within 0.2% up to +-0.5; clamped
+                               to +-2.4 where it meets +-1 with zero slope, so the
+                               clip has no corner
+
+    The lookup table is the one juce::dsp::LadderFilter uses and stays the
+    default. It needs one table read per lane, whereas the other two are pure
+    multiply-adds (plus one divide for the Pade) and vectorise fully. The table
+    never changes, so one copy per precision is shared by every ladder in the
+    process, see SharedTables.
+*/
+namespace Saturation
+{
+    enum class Kernel
+    {
+        lookupTable,
+        pade,
+        polynomial
+    };
+
+    //==============================================================================
+    template <typename SampleType, typename V>
+    V broadcast (SampleType value) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            return value;
+       #if JUCE_USE_SIMD
+        else
+            return V::expand (value);
+       #endif
+    }
+
+    template <typename SampleType, typename V>
+    V clamp (V x, SampleType limit) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+            return juce::jlimit (-limit, limit, x);
+       #if JUCE_USE_SIMD
+        else
+            return V::min (V::max (x, V::expand (-limit)), V::expand (limit));
+       #endif
+    }
+
+    /** SIMDRegister has no divide; a fixed-size lane loop is vectorised by the compiler instead. */
+    template <typename SampleType, typename V>
+    V divide (V numerator, V denominator) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+        {
+            return numerator / denominator;
+        }
+       #if JUCE_USE_SIMD
+        else
+        {
+            alignas (V::SIMDRegisterSize) SampleType n[V::SIMDNumElements];
+            alignas (V::SIMDRegisterSize) SampleType d[V::SIMDNumElements];
+            numerator.copyToRawArray (n);
+            denominator.copyToRawArray (d);
+
+            for (size_t i = 0; i < V::SIMDNumElements; ++i)
+                n[i] /= d[i];
+
+            return V::fromRawArray (n);
+        }
+       #endif
+    }
+
+    //==============================================================================
+    template <typename SampleType, typename V>
+    V pade (V x) noexcept
+    {
+        x = clamp<SampleType> (x, SampleType (4.97));
+        const auto x2 = x * x;
+
+        const auto num = x * (((x2 + broadcast<SampleType, V> (SampleType (378))) * x2
+                                   + broadcast<SampleType, V> (SampleType (17325))) * x2
+                                   + broadcast<SampleType, V> (SampleType (135135)));
+        const auto den = ((x2 * broadcast<SampleType, V> (SampleType (28)) + broadcast<SampleType, V> (SampleType (3150))) * x2
+                              + broadcast<SampleType, V> (SampleType (62370))) * x2
+                              + broadcast<SampleType, V> (SampleType (135135));
+
+        return divide<SampleType> (num, den);
+    }
+
+    template <typename SampleType, typename V>
+    V polynomial (V x) noexcept
+    {
+        x = clamp<SampleType> (x, SampleType (2.4));
+        const auto x2 = x * x;
+
+        return x * ((((x2 * broadcast<SampleType, V> (SampleType (0.00054928743214843116))
+                          + broadcast<SampleType, V> (SampleType (-0.010882752553262187))) * x2
+                          + broadcast<SampleType, V> (SampleType (0.082))) * x2
+                          + broadcast<SampleType, V> (SampleType (-0.3175))) * x2
+                          + broadcast<SampleType, V> (SampleType (1)));
+    }
+
+    //==============================================================================
+    /** Constant offset the ladders add to their input stage. As the input stops the
+        states settle on this tiny DC level instead of decaying through the subnormal
+        range, so the ladder core is denormal-safe without relying on the FPU's
+        flush-to-zero mode. It is large enough that its square, which the pade and
+        polynomial kernels form from the feedback state, is still a normal float.
+        The low passes pass it through at -300 dB, far below the processor's
+        silence threshold; the high passes cancel it. A constant is used rather
+        than an alternating one, which the high passes would let through.
+    */
+    template <typename SampleType>
+    inline constexpr SampleType denormalGuard = SampleType (1.0e-15);
+
+    //==============================================================================
+    /** The read-only tanh tables, held through juce::SharedResourcePointer: built by
+        the first ladder that needs them and freed with the last one, so a session
+        full of instances keeps a single copy.
+    */
+    struct SharedTables
+    {
+        template <typename SampleType>
+        const juce::dsp::LookupTableTransform<SampleType>& getTanh() const noexcept
+        {
+            if constexpr (std::is_same_v<SampleType, float>)
+                return tanhFloat;
+            else
+                return tanhDouble;
+        }
+
+        const juce::dsp::LookupTableTransform<float> tanhFloat { [] (float x) { return std::tanh (x); }, -5.0f, 5.0f, 128 };
+        const juce::dsp::LookupTableTransform<double> tanhDouble { [] (double x) { return std::tanh (x); }, -5.0, 5.0, 128 };
+    };
+
+    /** Applies a per-sample function to each lane; used for the table lookup. */
+    template <typename SampleType, typename V, typename Function>
+    V perLane (V x, Function&& f) noexcept
+    {
+        if constexpr (std::is_same_v<V, SampleType>)
+        {
+            return f (x);
+        }
+       #if JUCE_USE_SIMD
+        else
+        {
+            alignas (V::SIMDRegisterSize) SampleType lanes[V::SIMDNumElements];
+            x.copyToRawArray (lanes);
+
+            for (auto& lane : lanes)
+                lane = f (lane);
+
+            return V::fromRawArray (lanes);
+        }
+       #endif
+    }
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "EditorWorker.h"
+
+//==============================================================================
+/**
+    Pre and post filter spectra, read from the processor's SpectrumTap.
+
+    The shared editor worker drains the tap, runs a Hann windowed FFT every
+    hopSize samples, smooths the magnitudes (fast attack, slow release) and
+    builds both curves as unit-space paths. The message thread only swaps the
+    paths in when refresh() is called from the editor timer, which bounds the
+    frame rate. The tap is switched on for as long as this component exists.
+*/
+class SpectrumAnalyser  : public juce::Component, private juce::TimeSliceClient
+{
+public:
+    explicit SpectrumAnalyser (LadderFilterBasicAudioProcessor& p) : processor (p)
+    {
+        setOpaque (false);
+
+        for (auto& s : sides)
+        {
+            s.history.assign ((size_t) fftSize, 0.0f);
+            s.smoothedDb.assign ((size_t) numBins, minDb);
+        }
+
+        processor.getSpectrumTap().setActive (true);
+        worker->addTimeSliceClient (this);
+    }
+
+    ~SpectrumAnalyser() override
+    {
+        worker->removeTimeSliceClient (this);
+        processor.getSpectrumTap().setActive (false);
+    }
+
+    /** Call from a message thread timer; repaints only when the worker has a new frame. */
+    void refresh()
+    {
+        if (! frameReady.exchange (false, std::memory_order_acquire))
+            return;
+
+        {
+            const juce::SpinLock::ScopedLockType lock (frameLock);
+
+            for (int side = 0; side < SpectrumTap::numSides; ++side)
+                std::swap (curves[side], pendingCurves[side]);
+        }
+
+        repaint();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        const auto bounds = getLocalBounds().toFloat();
+        const auto toBounds = juce::AffineTransform::scale (bounds.getWidth(), bounds.getHeight());
+
+        g.setColour (juce::Colours::black.withAlpha (0.3f));
+        g.fillRoundedRectangle (bounds, 3.0f);
+
+        g.setColour (juce::Colours::lightgrey.withAlpha (0.35f));
+        g.strokePath (curves[SpectrumTap::pre], juce::PathStrokeType (1.0f), toBounds);
+
+        g.setColour (juce::Colours::skyblue.withAlpha (0.8f));
+        g.strokePath (curves[SpectrumTap::post], juce::PathStrokeType (1.0f), toBounds);
+    }
+
+private:
+    //==============================================================================
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr int numPoints = 256;
+
+    static constexpr float minDb = -96.0f, maxDb = 6.0f;
+    static constexpr float releasePerFrame = 0.8f;  // dB fall is smoothed, rises show at once
+    static constexpr double minFrequency = 20.0, maxFrequency = 20000.0;
+
+    /** Rolling input and smoothed spectrum of one side. Worker thread only. */
+    struct Side
+    {
+        std::vector<float> history;     // last fftSize samples, circular
+        int writePosition = 0;
+        int samplesSinceFrame = 0;
+        std::vector<float> smoothedDb;
+    };
+
+    int useTimeSlice() override
+    {
+        static constexpr int pollIntervalMs = 15;
+        bool newFrame = false;
+
+        for (int side = 0; side < SpectrumTap::numSides; ++side)
+        {
+            auto& s = sides[side];
+            int numRead;
+
+            while ((numRead = processor.getSpectrumTap().pull ((SpectrumTap::Side) side, incoming, hopSize)) > 0)
+            {
+                for (int i = 0; i < numRead; ++i)
+                {
+                    s.history[(size_t) s.writePosition] = incoming[i];
+                    s.writePosition = (s.writePosition + 1) % fftSize;
+                }
+
+                s.samplesSinceFrame += numRead;
+
+                if (s.samplesSinceFrame >= hopSize)
+                {
+                    s.samplesSinceFrame %= hopSize;
+                    analyse (s);
+                    newFrame = true;
+                }
+            }
+        }
+
+        if (newFrame)
+            buildCurves();
+
+        return pollIntervalMs;
+    }
+
+    void analyse (Side& s)
+    {
+        // Unroll the circular history, oldest sample first
+        for (int i = 0; i < fftSize; ++i)
+            fftData[i] = s.history[(size_t) ((s.writePosition + i) % fftSize)];
+
+        std::fill (fftData + fftSize, fftData + 2 * fftSize, 0.0f);
+
+        window.multiplyWithWindowingTable (fftData, (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform (fftData, true);
+
+        // Hann has a coherent gain of 0.5, so a full scale sine reads 0 dB
+        const auto scale = 4.0f / (float) fftSize;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto db = juce::Decibels::gainToDecibels (fftData[bin] * scale, minDb);
+            auto& smoothed = s.smoothedDb[(size_t) bin];
+            smoothed = juce::jmax (db, smoothed - releasePerFrame);
+        }
+    }
+
+    void buildCurves()
+    {
+        const auto sampleRate = processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 44100.0;
+        juce::Path paths[SpectrumTap::numSides];
+
+        for (int side = 0; side < SpectrumTap::numSides; ++side)
+        {
+            const auto& smoothed = sides[side].smoothedDb;
+
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto x = (double) i / (numPoints - 1);
+                const auto frequency = minFrequency * std::pow (maxFrequency / minFrequency, x);
+                const auto position = juce::jlimit (0.0, (double) numBins - 1.001, frequency / sampleRate * fftSize);
+
+                const auto bin = (int) position;
+                const auto fraction = (float) (position - bin);
+                const auto db = smoothed[(size_t) bin] + (smoothed[(size_t) bin + 1] - smoothed[(size_t) bin]) * fraction;
+                const auto y = 1.0f - (juce::jlimit (minDb, maxDb, db) - minDb) / (maxDb - minDb);
+
+                if (i == 0)
+                    paths[side].startNewSubPath ((float) x, y);
+                else
+                    paths[side].lineTo ((float) x, y);
+            }
+        }
+
+        {
+            const juce::SpinLock::ScopedLockType lock (frameLock);
+
+            for (int side = 0; side < SpectrumTap::numSides; ++side)
+                std::swap (pendingCurves[side], paths[side]);
+        }
+
+        frameReady.store (true, std::memory_order_release);
+    }
+
+    //==============================================================================
+    LadderFilterBasicAudioProcessor& processor;
+    juce::SharedResourcePointer<EditorWorker> worker;
+
+    // Worker thread only
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    float fftData[2 * fftSize] {};
+    float incoming[hopSize] {};
+    Side sides[SpectrumTap::numSides];
+
+    juce::SpinLock frameLock;
+    juce::Path pendingCurves[SpectrumTap::numSides];    // guarded by frameLock
+    std::atomic<bool> frameReady { false };
+
+    juce::Path curves[SpectrumTap::numSides];           // message thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyser)
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Hands the processor's input and output to the spectrum analyser.
+
+    processBlock mixes each side down to mono float, whichever precision the
+    host runs at, and writes it into a wait-free single producer, single
+    consumer FIFO; the analyser's background thread reads it. Everything is
+    allocated in prepare(), and nothing is written at all until a reader calls
+    setActive(true), so with the editor closed the tap costs one relaxed
+    atomic load per block. If the reader falls behind, the newest samples are
+    dropped rather than blocking the audio thread.
+*/
+class SpectrumTap
+{
+public:
+    enum Side
+    {
+        pre,
+        post,
+        numSides
+    };
+
+    static constexpr int fifoSize = 16384;
+
+    /** Not realtime safe. */
+    void prepare (int maximumBlockSize)
+    {
+        for (auto& f : fifos)
+        {
+            f.buffer.assign ((size_t) fifoSize, 0.0f);
+            f.fifo.reset();
+        }
+
+        mono.assign ((size_t) juce::jmax (1, maximumBlockSize), 0.0f);
+    }
+
+    void setActive (bool shouldBeActive) noexcept   { active.store (shouldBeActive, std::memory_order_relaxed); }
+    bool isActive() const noexcept                  { return active.load (std::memory_order_relaxed); }
+
+    /** Audio thread. Writes the block's mono mix for one side. */
+    template <typename SampleType>
+    void push (Side side, const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numChannels = block.getNumChannels();
+        const auto numSamples = juce::jmin (block.getNumSamples(), mono.size());
+
+        if (numChannels == 0 || numSamples == 0)
+            return;
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            std::copy (block.getChannelPointer (0), block.getChannelPointer (0) + numSamples, mono.begin());
+
+            for (size_t ch = 1; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::add (mono.data(), block.getChannelPointer (ch), (int) numSamples);
+        }
+        else
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                SampleType sum = 0;
+
+                for (size_t ch = 0; ch < numChannels; ++ch)
+                    sum += block.getChannelPointer (ch)[i];
+
+                mono[i] = (float) sum;
+            }
+        }
+
+        if (numChannels > 1)
+            juce::FloatVectorOperations::multiply (mono.data(), 1.0f / (float) numChannels, (int) numSamples);
+
+        auto& f = fifos[side];
+        const auto scope = f.fifo.write ((int) numSamples);
+
+        if (scope.blockSize1 > 0)
+            std::copy (mono.begin(), mono.begin() + scope.blockSize1, f.buffer.begin() + scope.startIndex1);
+
+        if (scope.blockSize2 > 0)
+            std::copy (mono.begin() + scope.blockSize1, mono.begin() + scope.blockSize1 + scope.blockSize2,
+                       f.buffer.begin() + scope.startIndex2);
+    }
+
+    /** Reader thread. Copies up to maxSamples of one side into dest and returns how many it got. */
+    int pull (Side side, float* dest, int maxSamples) noexcept
+    {
+        auto& f = fifos[side];
+        const auto scope = f.fifo.read (maxSamples);
+
+        if (scope.blockSize1 > 0)
+            std::copy (f.buffer.begin() + scope.startIndex1, f.buffer.begin() + scope.startIndex1 + scope.blockSize1, dest);
+
+        if (scope.blockSize2 > 0)
+            std::copy (f.buffer.begin() + scope.startIndex2, f.buffer.begin() + scope.startIndex2 + scope.blockSize2,
+                       dest + scope.blockSize1);
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    struct Fifo
+    {
+        juce::AbstractFifo fifo { fifoSize };
+        std::vector<float> buffer;
+    };
+
+    Fifo fifos[numSides];
+    std::vector<float> mono;    // audio thread scratch
+    std::atomic<bool> active { false };
+};
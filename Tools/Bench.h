@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+    Shared set-up for the ladder_bench modes: preparing a processor or a bare
+    ladder the way the modes use them, feeding it blocks and timing only the
+    processing, and the checks the modes assert with.
+
+    Every mode prints CSV to stdout and returns 0, or 1 once any of its
+    invariants fails, with the reason on stderr.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace Bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double defaultSampleRate = 48000.0;
+
+    //==============================================================================
+    inline void setParameter (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+    {
+        auto* parameter = apvts.getParameter (parameterID);
+        jassert (parameter != nullptr);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    inline bool setChannelLayout (juce::AudioProcessor& processor, int numChannels)
+    {
+        auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+        if (channelSet.isDisabled())
+            channelSet = juce::AudioChannelSet::discreteChannels (numChannels);
+
+        // Start from the current layout so any further buses (the sidechain) are left as they are
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference (0) = channelSet;
+        layout.outputBuses.getReference (0) = channelSet;
+
+        return processor.setBusesLayout (layout);
+    }
+
+    /** Parameter values by ID, set in order before prepareToPlay. */
+    using Settings = std::initializer_list<std::pair<const char*, float>>;
+
+    /** Sets the main bus width and the parameters, then prepares the processor as a host
+        would before playback. Returns false if the layout isn't supported. */
+    inline bool prepareProcessor (LadderFilterBasicAudioProcessor& processor, int numChannels, int blockSize,
+                                  Settings settings, double sampleRate = defaultSampleRate)
+    {
+        if (! setChannelLayout (processor, numChannels))
+            return false;
+
+        for (auto& [parameterID, value] : settings)
+            setParameter (processor.apvts, parameterID, value);
+
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+        return true;
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    void fillWithNoise (juce::AudioBuffer<SampleType>& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = SampleType (random.nextFloat() - 0.5f);
+        }
+    }
+
+    /** The same noise every call, so renders compared against each other see identical input. */
+    template <typename SampleType>
+    void fillWithNoise (juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random (0x1adde4);
+        fillWithNoise (buffer, random);
+    }
+
+    /** Copies every channel of buffer from source, starting at sourceStart. */
+    template <typename SampleType>
+    void copyBlock (juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& source, int sourceStart)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            buffer.copyFrom (ch, 0, source, ch, sourceStart, buffer.getNumSamples());
+    }
+
+    //==============================================================================
+    struct Ignore
+    {
+        template <typename... Args>
+        void operator() (Args&&...) const noexcept {}
+    };
+
+    /** Runs numBlocks blocks through processBlock. fillBlock (index, buffer, midi) writes each
+        block's input and afterBlock (index, buffer) sees its output; only processBlock is timed.
+        The MIDI buffer is cleared after every block. */
+    template <typename SampleType, typename FillBlock, typename AfterBlock = Ignore>
+    Clock::duration processBlocks (juce::AudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, int numBlocks,
+                                   FillBlock&& fillBlock, AfterBlock&& afterBlock = {})
+    {
+        juce::MidiBuffer midi;
+        Clock::duration elapsed {};
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillBlock (block, buffer, midi);
+
+            const auto start = Clock::now();
+            processor.processBlock (buffer, midi);
+            elapsed += Clock::now() - start;
+
+            afterBlock (block, buffer);
+            midi.clear();
+        }
+
+        return elapsed;
+    }
+
+    /** Nanoseconds per single channel sample. */
+    inline double nsPerSample (Clock::duration elapsed, double numBlocks, int blockSize, int numChannels)
+    {
+        return numBlocks > 0 ? (double) std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count()
+                                 / (numBlocks * blockSize * numChannels)
+                             : 0.0;
+    }
+
+    //==============================================================================
+    struct LadderSettings
+    {
+        juce::dsp::LadderFilterMode mode = juce::dsp::LadderFilterMode::LPF12;
+        Saturation::Kernel kernel = Saturation::Kernel::lookupTable;
+        double cutoff = 1000.0;
+        double resonance = 0.5;
+        double drive = 2.0;
+    };
+
+    /** A bare ladder with the given settings, reset. Layout, kernel choice and control interval
+        can still be changed afterwards. */
+    template <typename SampleType>
+    void prepareLadder (LadderEngine<SampleType>& ladder, int numChannels, int blockSize, const LadderSettings& settings,
+                        double sampleRate = defaultSampleRate)
+    {
+        ladder.prepare ({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        ladder.setMode (settings.mode);
+        ladder.setSaturation (settings.kernel);
+        ladder.setCutoffFrequencyHz ((SampleType) settings.cutoff);
+        ladder.setResonance ((SampleType) settings.resonance);
+        ladder.setDrive ((SampleType) settings.drive);
+        ladder.reset();
+    }
+
+    /** Filters the buffer in place, blockSize samples at a time, calling beforeBlock (start) ahead
+        of each block. Returns the time spent in the ladder. */
+    template <typename SampleType, typename BeforeBlock = Ignore>
+    Clock::duration processLadder (LadderEngine<SampleType>& ladder, juce::AudioBuffer<SampleType>& buffer, int blockSize,
+                                   BeforeBlock&& beforeBlock = {})
+    {
+        Clock::duration elapsed {};
+
+        for (int start = 0; start + blockSize <= buffer.getNumSamples(); start += blockSize)
+        {
+            beforeBlock (start);
+
+            auto block = juce::dsp::AudioBlock<SampleType> (buffer).getSubBlock ((size_t) start, (size_t) blockSize);
+
+            const auto blockStart = Clock::now();
+            ladder.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+            elapsed += Clock::now() - blockStart;
+        }
+
+        return elapsed;
+    }
+
+    //==============================================================================
+    /** Largest absolute difference between two renders of the same shape. */
+    template <typename A, typename B>
+    double maxAbsDifference (const juce::AudioBuffer<A>& a, const juce::AudioBuffer<B>& b)
+    {
+        double maxDiff = 0.0;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                maxDiff = juce::jmax (maxDiff, std::abs ((double) a.getSample (ch, i) - (double) b.getSample (ch, i)));
+
+        return maxDiff;
+    }
+
+    /** RMS of the difference against the RMS of the reference, in dB. */
+    template <typename Actual, typename Reference>
+    double errorDb (const Actual* actual, const Reference* reference, int numSamples)
+    {
+        double error = 0.0, power = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto diff = (double) actual[i] - (double) reference[i];
+            error += diff * diff;
+            power += (double) reference[i] * (double) reference[i];
+        }
+
+        // Measured against a floor, so near-silent renders (a high pass fed DC) don't blow up
+        return juce::Decibels::gainToDecibels (std::sqrt (error / juce::jmax (power, numSamples * 1.0e-8)), -300.0);
+    }
+
+    /** As errorDb, over every channel. */
+    template <typename Actual, typename Reference>
+    double errorDb (const juce::AudioBuffer<Actual>& actual, const juce::AudioBuffer<Reference>& reference)
+    {
+        double error = 0.0, power = 0.0;
+
+        for (int ch = 0; ch < actual.getNumChannels(); ++ch)
+        {
+            for (int i = 0; i < actual.getNumSamples(); ++i)
+            {
+                const auto r = (double) reference.getSample (ch, i);
+                const auto diff = (double) actual.getSample (ch, i) - r;
+                error += diff * diff;
+                power += r * r;
+            }
+        }
+
+        const auto numSamples = (double) actual.getNumChannels() * actual.getNumSamples();
+        return juce::Decibels::gainToDecibels (std::sqrt (error / juce::jmax (power, numSamples * 1.0e-8)), -300.0);
+    }
+
+    template <typename SampleType>
+    bool isFinite (const juce::AudioBuffer<SampleType>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                if (! std::isfinite (buffer.getSample (ch, i)))
+                    return false;
+
+        return true;
+    }
+
+    /** Reports a failed invariant on stderr. Returns false, so a check can end in it. */
+    inline bool fail (const juce::String& what)
+    {
+        std::cerr << what << '\n';
+        return false;
+    }
+
+    //==============================================================================
+    // BenchEngine.cpp: the bare ladder
+    int runControlRate();
+    int runKernels();
+    int runLayouts();
+    int runDenormals();
+
+    // BenchProcessor.cpp: processBlock as a host drives it
+    int runMatrix (const juce::ArgumentList& args);
+    int runParameterLookup();
+    int runSilence();
+    int runInstrumentation();
+    int runPrecision();
+    int runVoices();
+    int runSidechain();
+    int runPrograms();
+
+    // BenchSession.cpp: many instances, and reading from disk
+    int runState();
+    int runMemory (int numInstances);
+    int runRead (const juce::File& file);
+
+    // BenchVerify.cpp: the correctness and performance gate
+    int runVerify (const juce::ArgumentList& args);
+}
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    ladder_bench modes that drive LadderEngine on its own: the coefficient
+    control interval, the per mode kernels, the channel layouts and the cost
+    of a decay into the subnormal range.
+
+  ==============================================================================
+*/
+
+#include "Bench.h"
+
+namespace Bench
+{
+    //==============================================================================
+    /** Cost and accuracy of the ladder's coefficient control interval while the cutoff is swept.
+        Interval 1 evaluates exp() every sample and is the reference the others are compared to;
+        each interval, the shipped one included, fails if its output strays from it by more than
+        maxDeviationDb of the signal energy. */
+    int runControlRate()
+    {
+        constexpr double maxDeviationDb = -60.0;
+        constexpr int numChannels = 2, blockSize = 32;
+        constexpr int numSamples = (int) defaultSampleRate * 4;
+
+        juce::AudioBuffer<float> source (numChannels, numSamples);
+        fillWithNoise (source);
+
+        const auto render = [&] (int interval, juce::AudioBuffer<float>& output)
+        {
+            LadderEngine<float> ladder;
+            prepareLadder (ladder, numChannels, blockSize, { juce::dsp::LadderFilterMode::LPF24, Saturation::Kernel::lookupTable,
+                                                             1000.0, 0.7, 2.0 });
+            ladder.setControlInterval (interval);
+
+            // Each move glides across its block, as the processor does with host automation
+            ladder.setRampLength (blockSize);
+
+            output.makeCopyOf (source);
+
+            const auto elapsed = processLadder (ladder, output, blockSize, [&] (int start)
+            {
+                // 2 Hz sweep between 200 Hz and 10 kHz, updated once per block like host automation
+                const auto lfo = 0.5 + 0.5 * std::sin (juce::MathConstants<double>::twoPi * 2.0 * start / defaultSampleRate);
+                ladder.setCutoffFrequencyHz ((float) (200.0 * std::pow (50.0, lfo)));
+            });
+
+            return nsPerSample (elapsed, 1.0, numSamples, numChannels);
+        };
+
+        juce::AudioBuffer<float> reference, output;
+        const auto referenceNs = render (1, reference);
+
+        std::cout << "interval,ns_per_sample,deviation_db,max_abs_diff\n"
+                  << "1," << juce::String (referenceNs, 3) << ",-inf,0\n";
+
+        bool passed = true;
+
+        for (auto interval : { 8, 16, 32 })
+        {
+            const auto ns = render (interval, output);
+            const auto deviationDb = errorDb (output, reference);
+
+            std::cout << interval << ','
+                      << juce::String (ns, 3) << ','
+                      << juce::String (deviationDb, 1) << ','
+                      << maxAbsDifference (output, reference) << '\n';
+
+            if (! (deviationDb <= maxDeviationDb))
+                passed = fail ("interval " + juce::String (interval) + " deviates " + juce::String (deviationDb, 1)
+                                 + " dB from per-sample coefficients, limit " + juce::String (maxDeviationDb) + " dB");
+        }
+
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Each per mode ladder kernel against the generic run-time taps kernel, for every saturation
+        quality. They run the same arithmetic in a different order, so they may only differ by
+        float rounding; maxKernelDiff is well above that and well below anything audible. */
+    int runKernels()
+    {
+        constexpr double maxKernelDiff = 1.0e-5;
+        constexpr int numChannels = 2, blockSize = 512;
+        constexpr int numSamples = blockSize * 256;
+
+        juce::AudioBuffer<float> source (numChannels, numSamples);
+        fillWithNoise (source);
+
+        const auto render = [&] (int type, int quality, bool specialised, juce::AudioBuffer<float>& output)
+        {
+            LadderEngine<float> ladder;
+            prepareLadder (ladder, numChannels, blockSize, { (juce::dsp::LadderFilterMode) type, (Saturation::Kernel) quality });
+            ladder.setUseSpecialisedKernels (specialised);
+
+            output.makeCopyOf (source);
+            return nsPerSample (processLadder (ladder, output, blockSize), 1.0, numSamples, numChannels);
+        };
+
+        LadderFilterBasicAudioProcessor reference;
+        juce::AudioBuffer<float> generic, specialised;
+        bool passed = true;
+
+        std::cout << "type,quality,generic_ns_per_sample,specialised_ns_per_sample,speedup,max_abs_diff\n";
+
+        for (int type = 0; type < 6; ++type)
+            for (int quality = 0; quality < 3; ++quality)
+            {
+                const auto genericNs = render (type, quality, false, generic);
+                const auto specialisedNs = render (type, quality, true, specialised);
+                const auto maxDiff = maxAbsDifference (generic, specialised);
+
+                std::cout << reference.filterTypes[type] << ','
+                          << quality << ','
+                          << juce::String (genericNs, 3) << ','
+                          << juce::String (specialisedNs, 3) << ','
+                          << juce::String (genericNs / specialisedNs, 2) << ','
+                          << maxDiff << '\n';
+
+                if (! (maxDiff <= maxKernelDiff))
+                    passed = fail (juce::String (reference.filterTypes[type]) + " quality " + juce::String (quality)
+                                     + ": specialised kernel differs by " + juce::String (maxDiff));
+            }
+
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** The bare ladder on the scalar and the SIMD channel layouts, for 1 to 8 channels in
+        each precision and saturation kernel, and the layout LadderEngine picks by itself.
+        These are the figures LadderEngine::chooseVectorised is based on; --verify checks
+        the layouts agree. */
+    template <typename SampleType>
+    void runLayouts (const char* precision)
+    {
+        using Layout = typename LadderEngine<SampleType>::Layout;
+
+        constexpr int blockSize = 512, numBlocks = 256;
+
+        const auto render = [&] (int numChannels, int quality, Layout layout, bool& vectorised)
+        {
+            LadderEngine<SampleType> ladder;
+            prepareLadder (ladder, numChannels, blockSize, { juce::dsp::LadderFilterMode::LPF24, (Saturation::Kernel) quality });
+            ladder.setLayout (layout);
+            vectorised = ladder.isVectorised();
+
+            juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+            juce::Random random (0x1a7);
+            auto fastest = Clock::duration::max();
+
+            // Best of three passes, fresh noise each block
+            for (int pass = 0; pass < 3; ++pass)
+            {
+                Clock::duration elapsed {};
+
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    fillWithNoise (buffer, random);
+                    elapsed += processLadder (ladder, buffer, blockSize);
+                }
+
+                fastest = std::min (fastest, elapsed);
+            }
+
+            return nsPerSample (fastest, numBlocks, blockSize, numChannels);
+        };
+
+        for (int quality = 0; quality < 3; ++quality)
+        {
+            for (int numChannels = 1; numChannels <= 8; ++numChannels)
+            {
+                bool scalarPicked = false, simdPicked = false, automaticPicked = false;
+                const auto scalarNs = render (numChannels, quality, Layout::scalar, scalarPicked);
+                const auto simdNs = render (numChannels, quality, Layout::vectorised, simdPicked);
+                render (numChannels, quality, Layout::automatic, automaticPicked);
+
+                std::cout << precision << ',' << quality << ',' << numChannels << ','
+                          << juce::String (scalarNs, 3) << ',' << juce::String (simdNs, 3) << ','
+                          << juce::String (scalarNs / simdNs, 2) << ','
+                          << (automaticPicked ? "simd" : "scalar") << '\n';
+            }
+        }
+    }
+
+    int runLayouts()
+    {
+        std::cout << "precision,quality,channels,scalar_ns_per_sample,simd_ns_per_sample,simd_speedup,automatic\n";
+        runLayouts<float> ("float");
+        runLayouts<double> ("double");
+        return 0;
+    }
+
+    //==============================================================================
+    /** Per sample cost of the bare ladder while an impulse decays into silence,
+        with flush-to-zero off as in the offline tools. Without the denormal
+        guard the later windows, where the state would be subnormal, slow down;
+        with it every window should cost about the same. Returns the slowest
+        window's cost over the fastest's.
+    */
+    template <typename SampleType>
+    double runDecay (const char* name)
+    {
+        constexpr int numChannels = 2, blockSize = 256, blocksPerWindow = 200, numWindows = 12;
+
+        LadderEngine<SampleType> ladder;
+        prepareLadder (ladder, numChannels, blockSize, { juce::dsp::LadderFilterMode::LPF12, Saturation::Kernel::pade,
+                                                         1000.0, 0.3, 1.0 });
+
+        juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+        double fastest = 0.0, slowest = 0.0;
+
+        for (int window = 0; window < numWindows; ++window)
+        {
+            Clock::duration elapsed {};
+
+            for (int block = 0; block < blocksPerWindow; ++block)
+            {
+                buffer.clear();
+
+                if (window == 0 && block == 0)
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        buffer.setSample (ch, 0, SampleType (1));
+
+                elapsed += processLadder (ladder, buffer, blockSize);
+            }
+
+            const auto ns = nsPerSample (elapsed, blocksPerWindow, blockSize, numChannels);
+
+            fastest = window == 0 ? ns : std::min (fastest, ns);
+            slowest = window == 0 ? ns : std::max (slowest, ns);
+
+            std::cout << name << ',' << (window + 1) * blocksPerWindow * blockSize * 1000.0 / defaultSampleRate << ',' << ns << '\n';
+        }
+
+        return slowest / fastest;
+    }
+
+    /** Fails if any window of the decay costs more than maxSpread times the cheapest. Subnormal
+        arithmetic costs ten times and more on x86, so an unguarded ladder fails by far; timer
+        noise on a guarded one stays around 1.3. */
+    int runDenormals()
+    {
+        constexpr double maxSpread = 2.0;
+
+        std::cout << "precision,ms_after_impulse,ns_per_sample\n";
+
+        const auto floatSpread = runDecay<float> ("float");
+        const auto doubleSpread = runDecay<double> ("double");
+
+        std::cout << "float_slowest_over_fastest," << floatSpread << '\n'
+                  << "double_slowest_over_fastest," << doubleSpread << '\n';
+
+        if (floatSpread <= maxSpread && doubleSpread <= maxSpread)
+            return 0;
+
+        fail ("the decay slows down by more than " + juce::String (maxSpread) + " times as it fades");
+        return 1;
+    }
+}
@@ -0,0 +1,661 @@
+/*
+  ==============================================================================
+
+    ladder_bench modes that drive LadderFilterBasicAudioProcessor through
+    processBlock as a host would: the render matrix, parameter handling,
+    sleep, instrumentation, precision, the voice bank, the sidechain and
+    program changes.
+
+  ==============================================================================
+*/
+
+#include "Bench.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // Keeps the parameter reads in runParameterLookup() from being optimised away
+        volatile float parameterSink = 0.0f;
+
+        struct BenchConfig
+        {
+            int type;
+            int quality;
+            double sampleRate;
+            int numChannels;
+            int blockSize;
+        };
+
+        struct BenchResult
+        {
+            double nsPerSample      = 0.0;
+            double samplesPerSecond = 0.0;
+            double realtimeFactor   = 0.0;
+            double worstBlockMicros = 0.0;
+        };
+
+        bool runConfig (const BenchConfig& config, double secondsToRender, BenchResult& result)
+        {
+            LadderFilterBasicAudioProcessor processor;
+
+            if (! prepareProcessor (processor, config.numChannels, config.blockSize,
+                                    { { "CUTOFF", 1000.0f }, { "RESONANCE", 0.5f }, { "DRIVE", 2.0f },
+                                      { "TYPE", (float) config.type }, { "QUALITY", (float) config.quality } },
+                                    config.sampleRate))
+                return false;
+
+            // Always render enough blocks for the worst-case figure to mean something
+            const auto numBlocks = juce::jmax (32, (int) (secondsToRender * config.sampleRate) / config.blockSize);
+            const auto numWarmupBlocks = juce::jmax (4, numBlocks / 10);
+
+            juce::AudioBuffer<float> source (config.numChannels, config.blockSize * numBlocks);
+            juce::AudioBuffer<float> buffer (config.numChannels, config.blockSize);
+            fillWithNoise (source);
+
+            const auto fill = [&] (int block, juce::AudioBuffer<float>& b, juce::MidiBuffer&)
+            {
+                copyBlock (b, source, block * config.blockSize);
+            };
+
+            processBlocks (processor, buffer, numWarmupBlocks, fill);
+
+            // One block at a time, for the worst case
+            Clock::duration total {}, worst {};
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                const auto elapsed = processBlocks (processor, buffer, 1, [&] (int, auto& b, auto& midi) { fill (block, b, midi); });
+                total += elapsed;
+                worst = juce::jmax (worst, elapsed);
+            }
+
+            processor.releaseResources();
+
+            const auto totalNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds> (total).count();
+            const auto numFrames = (double) numBlocks * config.blockSize;
+            const auto numSamples = numFrames * config.numChannels;
+
+            result.nsPerSample      = totalNs / numSamples;
+            result.samplesPerSecond = numSamples * 1.0e9 / totalNs;
+            result.realtimeFactor   = (numFrames / config.sampleRate) / (totalNs * 1.0e-9);
+            result.worstBlockMicros = (double) std::chrono::duration_cast<std::chrono::nanoseconds> (worst).count() * 1.0e-3;
+            return true;
+        }
+
+        /** The dirty mask at work: a static session must make no coefficient updates at
+            all, and moving one parameter must make exactly one. Returns false on a mismatch.
+        */
+        bool checkCoefficientUpdates()
+        {
+            constexpr int numChannels = 2, blockSize = 256, numBlocks = 64;
+
+            LadderFilterBasicAudioProcessor processor;
+            prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 1000.0f }, { "RESONANCE", 0.5f } });
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+            const auto render = [&]
+            {
+                const auto before = processor.getNumCoefficientUpdates();
+                processBlocks (processor, buffer, numBlocks, [] (int, auto& b, auto&) { fillWithNoise (b); });
+                return processor.getNumCoefficientUpdates() - before;
+            };
+
+            const auto staticUpdates = render();
+            setParameter (processor.apvts, "CUTOFF", 1500.0f);
+            const auto changedUpdates = render();
+
+            std::cout << "static_coefficient_updates," << staticUpdates << '\n'
+                      << "one_change_coefficient_updates," << changedUpdates << '\n';
+
+            return (staticUpdates == 0 && changedUpdates == 1)
+                || fail ("Expected 0 coefficient updates for a static session and 1 after one change");
+        }
+    }
+
+    //==============================================================================
+    int runMatrix (const juce::ArgumentList& args)
+    {
+        const auto quick = args.containsOption ("--quick");
+        const auto seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue()
+                                                               : (quick ? 0.1 : 0.5);
+        const auto quality = args.containsOption ("--quality") ? args.getValueForOption ("--quality").getIntValue() : 0;
+
+        const juce::Array<int> blockSizes = quick ? juce::Array<int> { 32, 512 }
+                                                  : juce::Array<int> { 1, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        const juce::Array<int> channelCounts = quick ? juce::Array<int> { 2 } : juce::Array<int> { 1, 2, 8, 12, 16 };
+        const juce::Array<double> sampleRates = quick ? juce::Array<double> { 48000.0 }
+                                                      : juce::Array<double> { 44100.0, 48000.0, 96000.0 };
+
+        LadderFilterBasicAudioProcessor reference;
+        juce::String csv ("type,quality,sample_rate,channels,block_size,ns_per_sample,samples_per_sec,realtime_factor,worst_block_us\n");
+
+        for (int type = 0; type < 6; ++type)
+            for (auto sampleRate : sampleRates)
+                for (auto numChannels : channelCounts)
+                    for (auto blockSize : blockSizes)
+                    {
+                        BenchResult r;
+
+                        if (! runConfig ({ type, quality, sampleRate, numChannels, blockSize }, seconds, r))
+                        {
+                            std::cerr << "Skipping unsupported layout with " << numChannels << " channels" << std::endl;
+                            continue;
+                        }
+
+                        juce::String row;
+                        row << juce::String (reference.filterTypes[type]) << ','
+                            << quality << ','
+                            << sampleRate << ','
+                            << numChannels << ','
+                            << blockSize << ','
+                            << juce::String (r.nsPerSample, 3) << ','
+                            << juce::String ((juce::int64) r.samplesPerSecond) << ','
+                            << juce::String (r.realtimeFactor, 1) << ','
+                            << juce::String (r.worstBlockMicros, 3) << '\n';
+
+                        std::cout << row << std::flush;
+                        csv << row;
+                    }
+
+        if (args.containsOption ("--output"))
+            if (! args.getFileForOption ("--output").replaceWithText (csv))
+                return 1;
+
+        return 0;
+    }
+
+    //==============================================================================
+    /** Per-block cost of reading the parameters by string ID versus the cached snapshot,
+        then checkCoefficientUpdates(). */
+    int runParameterLookup()
+    {
+        LadderFilterBasicAudioProcessor processor;
+        auto& apvts = processor.apvts;
+
+        ParameterSnapshot snapshot;
+        snapshot.attachTo (apvts);
+
+        constexpr int numIterations = 1000000;
+        float sink = 0.0f;
+
+        const auto start = Clock::now();
+
+        for (int i = 0; i < numIterations; ++i)
+            sink += apvts.getRawParameterValue ("CUTOFF")->load()
+                  + apvts.getRawParameterValue ("RESONANCE")->load()
+                  + apvts.getRawParameterValue ("DRIVE")->load()
+                  + apvts.getRawParameterValue ("TYPE")->load();
+
+        const auto lookup = Clock::now() - start;
+
+        for (int i = 0; i < numIterations; ++i)
+        {
+            const auto p = snapshot.load();
+            sink += p.cutoff + p.resonance + p.drive + (float) p.type;
+        }
+
+        const auto cached = Clock::now() - start - lookup;
+
+        const auto nsPerBlock = [] (Clock::duration d)
+        {
+            return (double) std::chrono::duration_cast<std::chrono::nanoseconds> (d).count() / numIterations;
+        };
+
+        std::cout << "method,ns_per_block\n"
+                  << "string_lookup," << nsPerBlock (lookup) << '\n'
+                  << "snapshot,"      << nsPerBlock (cached) << '\n';
+
+        parameterSink = sink;
+        return checkCoefficientUpdates() ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Cost of a silent track: a burst of noise, then silence until the processor sleeps and
+        after. Fails unless it falls asleep once the input stops (and not before), stays
+        silent while asleep, and costs less than half as much asleep as awake; sleeping
+        skips the ladder altogether, so the real gap is far wider.
+    */
+    int runSilence()
+    {
+        constexpr int numChannels = 2, blockSize = 512, noiseBlocks = 8;
+        constexpr int numBlocks = (int) defaultSampleRate * 10 / blockSize;
+
+        LadderFilterBasicAudioProcessor processor;
+        prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 200.0f }, { "RESONANCE", 0.75f } });
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+        Clock::duration awake {}, asleep {};
+        int numAwake = 0, numAsleep = 0, firstSleepingBlock = -1;
+        bool soundWhileAsleep = false;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto wasSleeping = processor.isSleeping();
+
+            const auto elapsed = processBlocks (processor, buffer, 1, [block] (int, auto& b, auto&)
+            {
+                if (block < noiseBlocks)
+                    fillWithNoise (b);
+                else
+                    b.clear();
+            });
+
+            (wasSleeping ? asleep : awake) += elapsed;
+            ++(wasSleeping ? numAsleep : numAwake);
+
+            if (wasSleeping && firstSleepingBlock < 0)
+                firstSleepingBlock = block;
+
+            if (wasSleeping && buffer.getMagnitude (0, blockSize) > 0.0f)
+                soundWhileAsleep = true;
+        }
+
+        const auto awakeNs = nsPerSample (awake, numAwake, blockSize, numChannels);
+        const auto asleepNs = nsPerSample (asleep, numAsleep, blockSize, numChannels);
+
+        std::cout << "tail_seconds," << processor.getTailLengthSeconds() << '\n'
+                  << "sleep_after_seconds," << (firstSleepingBlock < 0 ? -1.0 : (firstSleepingBlock - noiseBlocks) * blockSize / defaultSampleRate) << '\n'
+                  << "awake_ns_per_sample," << awakeNs << '\n'
+                  << "asleep_ns_per_sample," << asleepNs << '\n';
+
+        bool passed = true;
+
+        if (firstSleepingBlock < 0)
+            passed = fail ("never fell asleep in " + juce::String (numBlocks * blockSize / defaultSampleRate, 1) + " seconds");
+        else if (firstSleepingBlock <= noiseBlocks)
+            passed = fail ("fell asleep while the input was still playing");
+
+        if (soundWhileAsleep)
+            passed = fail ("made sound while asleep");
+
+        if (numAsleep > 0 && ! (asleepNs < 0.5 * awakeNs))
+            passed = fail ("asleep costs " + juce::String (asleepNs, 3) + " ns per sample against " + juce::String (awakeNs, 3) + " awake");
+
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Overhead of the processBlock instrumentation, and the stats it publishes. Fails if the
+        stats don't account for every timed block or are out of order (min, avg, p99, max). */
+    int runInstrumentation()
+    {
+        constexpr int numChannels = 2, blockSize = 128, numBlocks = 4096;
+
+        LadderFilterBasicAudioProcessor processor;
+        prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 1000.0f }, { "RESONANCE", 0.5f } });
+
+        juce::AudioBuffer<float> source (numChannels, blockSize * numBlocks), buffer (numChannels, blockSize);
+        fillWithNoise (source);
+
+        const auto render = [&]
+        {
+            const auto elapsed = processBlocks (processor, buffer, numBlocks, [&] (int block, auto& b, auto&)
+            {
+                copyBlock (b, source, block * blockSize);
+            });
+
+            return nsPerSample (elapsed, numBlocks, blockSize, numChannels);
+        };
+
+        render();
+        const auto disabledNs = render();
+
+        processor.setInstrumentationEnabled (true);
+        const auto enabledNs = render();
+        const auto stats = processor.getPerformanceStats();
+
+        std::cout << "disabled_ns_per_sample," << disabledNs << '\n'
+                  << "enabled_ns_per_sample," << enabledNs << '\n'
+                  << "blocks," << stats.numBlocks << '\n'
+                  << "min_us," << stats.minMicros << '\n'
+                  << "avg_us," << stats.avgMicros << '\n'
+                  << "p99_us," << stats.p99Micros << '\n'
+                  << "max_us," << stats.maxMicros << '\n'
+                  << "deadline_share," << stats.deadlineShare << '\n'
+                  << "peak_deadline_share," << stats.peakDeadlineShare << '\n'
+                  << "coefficient_updates," << stats.coefficientUpdates << '\n';
+
+        bool passed = true;
+
+        // Only the enabled pass is timed, and numBlocks is a multiple of the publish interval
+        if (stats.numBlocks != (juce::uint64) numBlocks)
+            passed = fail ("published " + juce::String (stats.numBlocks) + " timed blocks, rendered " + juce::String (numBlocks));
+
+        if (! (stats.minMicros <= stats.avgMicros && stats.avgMicros <= stats.maxMicros
+                && stats.minMicros <= stats.p99Micros && stats.p99Micros <= stats.maxMicros))
+            passed = fail ("block times out of order");
+
+        if (! (stats.deadlineShare > 0.0 && stats.deadlineShare <= stats.peakDeadlineShare))
+            passed = fail ("deadline share " + juce::String (stats.deadlineShare) + " against a peak of " + juce::String (stats.peakDeadlineShare));
+
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Float against double processBlock at full resonance: speed, and how far the float output
+        strays. Fails if the float error is above maxFloatErrorDb; it measures about -114 dB. */
+    int runPrecision()
+    {
+        constexpr double maxFloatErrorDb = -90.0;
+        constexpr int numChannels = 2, blockSize = 512, numBlocks = 1024;
+
+        juce::AudioBuffer<float> source (numChannels, blockSize * numBlocks);
+        fillWithNoise (source);
+        source.applyGain (0.1f);
+
+        const auto render = [&] (auto& output, juce::AudioProcessor::ProcessingPrecision precision)
+        {
+            LadderFilterBasicAudioProcessor processor;
+            processor.setProcessingPrecision (precision);
+            prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 300.0f }, { "RESONANCE", 0.75f },
+                                                                   { "DRIVE", 4.0f }, { "QUALITY", 1.0f } });
+
+            output.makeCopyOf (source);
+            std::remove_reference_t<decltype (output)> buffer (numChannels, blockSize);
+
+            const auto elapsed = processBlocks (processor, buffer, numBlocks,
+                                                [&] (int block, auto& b, auto&) { copyBlock (b, output, block * blockSize); },
+                                                [&] (int block, auto& b)
+                                                {
+                                                    for (int ch = 0; ch < numChannels; ++ch)
+                                                        output.copyFrom (ch, block * blockSize, b, ch, 0, blockSize);
+                                                });
+
+            return nsPerSample (elapsed, numBlocks, blockSize, numChannels);
+        };
+
+        juce::AudioBuffer<float> singleOutput;
+        juce::AudioBuffer<double> doubleOutput;
+        const auto singleNs = render (singleOutput, juce::AudioProcessor::singlePrecision);
+        const auto doubleNs = render (doubleOutput, juce::AudioProcessor::doublePrecision);
+        const auto errorDbValue = errorDb (singleOutput, doubleOutput);
+
+        std::cout << "float_ns_per_sample," << singleNs << '\n'
+                  << "double_ns_per_sample," << doubleNs << '\n'
+                  << "float_max_abs_diff," << maxAbsDifference (singleOutput, doubleOutput) << '\n'
+                  << "float_error_db," << errorDbValue << '\n';
+
+        if (isFinite (singleOutput) && isFinite (doubleOutput) && errorDbValue <= maxFloatErrorDb)
+            return 0;
+
+        fail ("float output strays " + juce::String (errorDbValue, 1) + " dB from double, limit " + juce::String (maxFloatErrorDb) + " dB");
+        return 1;
+    }
+
+    //==============================================================================
+    /** Cost of the voice bank as notes are added, against the single ladder. Fails on
+        output that isn't finite, if a held note doesn't take a voice, or if the bank
+        isn't decayed a second after its last note-off.
+    */
+    int runVoices()
+    {
+        constexpr int numChannels = 2, blockSize = 256, numBlocks = 2048;
+
+        juce::AudioBuffer<float> source (numChannels, blockSize);
+        fillWithNoise (source);
+        bool passed = true;
+
+        const auto render = [&] (bool voiceBank, int numNotes)
+        {
+            LadderFilterBasicAudioProcessor processor;
+            prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 500.0f }, { "RESONANCE", 0.6f },
+                                                                   { "VOICES", voiceBank ? 1.0f : 0.0f }, { "VELOCITY", 0.5f } });
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            bool finite = true;
+
+            const auto elapsed = processBlocks (processor, buffer, numBlocks,
+                                                [&] (int block, auto& b, auto& midi)
+                                                {
+                                                    b.makeCopyOf (source, true);
+
+                                                    if (block == 0)
+                                                        for (int note = 0; note < numNotes; ++note)
+                                                            midi.addEvent (juce::MidiMessage::noteOn (1, 48 + note * 3, (juce::uint8) 100), 0);
+                                                },
+                                                [&] (int, auto& b) { finite = finite && isFinite (b); });
+
+            if (! finite)
+                passed = fail (juce::String (numNotes) + " notes made output that isn't finite");
+
+            return nsPerSample (elapsed, numBlocks, blockSize, numChannels);
+        };
+
+        std::cout << "voices,ns_per_sample\n"
+                  << "ladder," << render (false, 0) << '\n';
+
+        for (auto numNotes : { 0, 1, 4, 8, 16 })
+            std::cout << numNotes << ',' << render (true, numNotes) << '\n';
+
+        // Once its last note has rung out the bank must report itself decayed, so the processor
+        // can sleep; free lanes in a sounding group are fed silence, so none is left holding input
+        LadderVoiceBank<float> bank;
+        bank.prepare ({ defaultSampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        bank.setCutoffFrequencyHz (500.0f);
+        bank.setResonance (0.6f);
+        bank.resetState();
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 100), 0);
+
+        constexpr int heldBlocks = 64, releasedBlocks = (int) defaultSampleRate / blockSize;
+
+        for (int block = 0; block < heldBlocks + releasedBlocks; ++block)
+        {
+            if (block == heldBlocks)
+            {
+                if (bank.getNumActiveVoices() != 1)
+                    passed = fail ("a held note has " + juce::String (bank.getNumActiveVoices()) + " voices");
+
+                midi.addEvent (juce::MidiMessage::noteOff (1, 60), 0);
+            }
+
+            buffer.makeCopyOf (source, true);
+            bank.process (juce::dsp::AudioBlock<float> (buffer), midi, 0, 1);
+            midi.clear();
+        }
+
+        if (bank.getNumActiveVoices() != 0 || ! bank.hasDecayed (1.0e-7f))
+            passed = fail ("voice bank still awake a second after its last note-off");
+
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Cost of sidechain modulation: none, a constant sidechain (folded into the
+        control-rate coefficients) and an audio-rate one (per sample coefficients),
+        at each oversampling factor. Fails if a layout with the sidechain is refused,
+        on output that isn't finite, or if either kind of modulation leaves the output
+        within maxUnmodulatedDb of the unmodulated render; it swings the cutoff two
+        octaves either way, so the renders differ at about 0 dB.
+    */
+    int runSidechain()
+    {
+        constexpr double maxUnmodulatedDb = -20.0;
+        constexpr int numChannels = 2, blockSize = 256, numBlocks = 2048;
+
+        juce::AudioBuffer<float> source (numChannels, blockSize);
+        fillWithNoise (source);
+
+        enum class Modulation { off, constant, audioRate };
+
+        const auto render = [&] (Modulation modulation, int oversampling, juce::AudioBuffer<float>& output)
+        {
+            LadderFilterBasicAudioProcessor processor;
+            auto layout = processor.getBusesLayout();
+            layout.inputBuses.getReference (1) = modulation == Modulation::off ? juce::AudioChannelSet::disabled()
+                                                                              : juce::AudioChannelSet::stereo();
+
+            if (! processor.setBusesLayout (layout)
+                || ! prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 800.0f }, { "RESONANCE", 0.5f },
+                                                                             { "SC_CUTOFF", 2.0f }, { "SC_RESONANCE", 0.25f },
+                                                                             { "OVERSAMPLING", (float) oversampling } }))
+                return -1.0;
+
+            // Main bus first, then the sidechain: a 3 Hz sine, or its value held
+            juce::AudioBuffer<float> buffer (processor.getTotalNumInputChannels(), blockSize);
+            output.setSize (numChannels, blockSize * numBlocks);
+
+            const auto elapsed = processBlocks (processor, buffer, numBlocks,
+                                                [&] (int block, auto& b, auto&)
+                                                {
+                                                    for (int ch = 0; ch < numChannels; ++ch)
+                                                        b.copyFrom (ch, 0, source, ch, 0, blockSize);
+
+                                                    const auto phase = block * blockSize / defaultSampleRate;
+
+                                                    for (int ch = numChannels; ch < b.getNumChannels(); ++ch)
+                                                    {
+                                                        for (int i = 0; i < blockSize; ++i)
+                                                        {
+                                                            const auto t = modulation == Modulation::audioRate ? phase + i / defaultSampleRate : phase;
+                                                            b.setSample (ch, i, (float) std::sin (juce::MathConstants<double>::twoPi * 3.0 * t));
+                                                        }
+                                                    }
+                                                },
+                                                [&] (int block, auto& b)
+                                                {
+                                                    for (int ch = 0; ch < numChannels; ++ch)
+                                                        output.copyFrom (ch, block * blockSize, b, ch, 0, blockSize);
+                                                });
+
+            return nsPerSample (elapsed, numBlocks, blockSize, numChannels);
+        };
+
+        juce::AudioBuffer<float> outputs[3];
+        bool passed = true;
+
+        std::cout << "oversampling,off_ns,constant_ns,audio_rate_ns\n";
+
+        for (int oversampling = 0; oversampling <= 3; ++oversampling)
+        {
+            const auto offNs = render (Modulation::off, oversampling, outputs[0]);
+            const auto constantNs = render (Modulation::constant, oversampling, outputs[1]);
+            const auto audioRateNs = render (Modulation::audioRate, oversampling, outputs[2]);
+
+            std::cout << (1 << oversampling) << ',' << offNs << ',' << constantNs << ',' << audioRateNs << '\n';
+
+            if (offNs < 0.0 || constantNs < 0.0 || audioRateNs < 0.0)
+            {
+                passed = fail ("sidechain layout refused");
+                continue;
+            }
+
+            for (int m = 0; m < 3; ++m)
+                if (! isFinite (outputs[m]))
+                    passed = fail (juce::String (1 << oversampling) + "x: output isn't finite");
+
+            for (int m = 1; m < 3; ++m)
+            {
+                const auto db = errorDb (outputs[m], outputs[0]);
+
+                if (! (db > maxUnmodulatedDb))
+                    passed = fail (juce::String (1 << oversampling) + "x: " + (m == 1 ? "constant" : "audio rate")
+                                     + " modulation is only " + juce::String (db, 1) + " dB away from none");
+            }
+        }
+
+        return passed ? 0 : 1;
+    }
+
+    //==============================================================================
+    /** Cost of changing program every 32 blocks and of sweeping the morph, against
+        steady settings, plus the largest step between neighbouring output samples
+        as a click detector. The input is a sine, so the floor is the largest step
+        any program makes while held steady; changes have to glide in under twice
+        that (an instant switch of the coefficients steps about ten times it). Also
+        fails if a program chosen on the message thread hasn't reached the
+        parameters by the time setCurrentProgram returns.
+    */
+    int runPrograms()
+    {
+        constexpr int numChannels = 2, blockSize = 128, numBlocks = 4096;
+
+        enum class Change { none, program, morph };
+        int unwrittenPrograms = 0;
+
+        const auto render = [&] (Change change, int program, double& maxStep)
+        {
+            LadderFilterBasicAudioProcessor processor;
+            processor.setCurrentProgram (program);
+            prepareProcessor (processor, numChannels, blockSize, { { "MORPH_TARGET", 2.0f } });
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            float previous = 0.0f;
+            maxStep = 0.0;
+
+            const auto elapsed = processBlocks (processor, buffer, numBlocks,
+                                                [&] (int block, auto& b, auto&)
+                                                {
+                                                    for (int i = 0; i < blockSize; ++i)
+                                                    {
+                                                        const auto phase = juce::MathConstants<double>::twoPi * 110.0 * (block * blockSize + i) / defaultSampleRate;
+
+                                                        for (int ch = 0; ch < numChannels; ++ch)
+                                                            b.setSample (ch, i, 0.25f * (float) std::sin (phase));
+                                                    }
+
+                                                    if (change == Change::program && block % 32 == 0)
+                                                    {
+                                                        const auto index = (block / 32) % processor.getNumPrograms();
+                                                        processor.setCurrentProgram (index);
+
+                                                        if (std::abs (processor.getParameterValues().cutoff - PresetBank::get (index).cutoff) > 0.01f * PresetBank::get (index).cutoff)
+                                                            ++unwrittenPrograms;
+                                                    }
+
+                                                    if (change == Change::morph)
+                                                        setParameter (processor.apvts, "MORPH", 0.5f + 0.5f * (float) std::sin (block * 0.01));
+                                                },
+                                                [&] (int block, auto& b)
+                                                {
+                                                    // Skip the first blocks, while the ladder settles from silence
+                                                    for (int i = 0; i < blockSize; ++i)
+                                                    {
+                                                        if (block >= 16)
+                                                            maxStep = std::max (maxStep, (double) std::abs (b.getSample (0, i) - previous));
+
+                                                        previous = b.getSample (0, i);
+                                                    }
+                                                });
+
+            return nsPerSample (elapsed, numBlocks, blockSize, numChannels);
+        };
+
+        std::cout << "change,ns_per_sample,max_step\n";
+
+        double steadyStep = 0.0;
+
+        for (int program = 0; program < PresetBank::numPrograms; ++program)
+        {
+            double maxStep = 0.0;
+            const auto ns = render (Change::none, program, maxStep);
+            std::cout << "steady " << PresetBank::get (program).name << ',' << ns << ',' << maxStep << '\n';
+            steadyStep = std::max (steadyStep, maxStep);
+        }
+
+        constexpr double maxStepRatio = 2.0;
+        bool passed = true;
+
+        for (auto [change, name] : { std::pair { Change::program, "program" },
+                                     std::pair { Change::morph, "morph" } })
+        {
+            double maxStep = 0.0;
+            const auto ns = render (change, 0, maxStep);
+            std::cout << name << ',' << ns << ',' << maxStep << '\n';
+
+            if (maxStep > maxStepRatio * steadyStep)
+                passed = fail (juce::String (name) + " changes step " + juce::String (maxStep) + ", over "
+                                 + juce::String (maxStepRatio) + " times the steady " + juce::String (steadyStep));
+        }
+
+        if (unwrittenPrograms > 0)
+            passed = fail (juce::String (unwrittenPrograms) + " program changes didn't reach the parameters synchronously");
+
+        return passed ? 0 : 1;
+    }
+}
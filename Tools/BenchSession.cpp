@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    ladder_bench modes about whole sessions rather than one render: saving
+    and restoring many instances, their memory footprint, and reading a large
+    file from disk.
+
+  ==============================================================================
+*/
+
+#include "Bench.h"
+#include "MappedAudioReader.h"
+
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+ #include <malloc.h>
+ #define LADDER_BENCH_HEAP_STATS 1
+#endif
+
+namespace Bench
+{
+    namespace
+    {
+        /** Bytes the allocator has handed out, or -1 where the C library can't tell. */
+        juce::int64 heapBytesInUse()
+        {
+           #if LADDER_BENCH_HEAP_STATS
+            return (juce::int64) mallinfo2().uordblks;
+           #else
+            return -1;
+           #endif
+        }
+    }
+
+    //==============================================================================
+    /** Saving and restoring the state of many instances, as opening a large session
+        does, in the binary format against the XML one it replaced.
+    */
+    int runState()
+    {
+        constexpr int numInstances = 1000;
+
+        std::vector<std::unique_ptr<LadderFilterBasicAudioProcessor>> processors;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            processors.push_back (std::make_unique<LadderFilterBasicAudioProcessor>());
+            setParameter (processors.back()->apvts, "CUTOFF", 100.0f + (float) i);
+            setParameter (processors.back()->apvts, "RESONANCE", 0.5f);
+            setParameter (processors.back()->apvts, "TYPE", (float) (i % 6));
+        }
+
+        std::vector<juce::MemoryBlock> blobs ((size_t) numInstances);
+
+        const auto time = [&] (auto&& perInstance)
+        {
+            const auto start = Clock::now();
+
+            for (int i = 0; i < numInstances; ++i)
+                perInstance (*processors[(size_t) i], blobs[(size_t) i]);
+
+            return (double) std::chrono::duration_cast<std::chrono::microseconds> (Clock::now() - start).count() / 1000.0;
+        };
+
+        const auto restore = [] (LadderFilterBasicAudioProcessor& processor, juce::MemoryBlock& blob)
+        {
+            processor.setStateInformation (blob.getData(), (int) blob.getSize());
+        };
+
+        std::cout << "format,save_ms,restore_ms,bytes_per_instance\n";
+
+        const auto binarySave = time ([] (LadderFilterBasicAudioProcessor& processor, juce::MemoryBlock& blob)
+        {
+            processor.getStateInformation (blob);
+        });
+
+        const auto binaryRestore = time (restore);
+        std::cout << "binary," << binarySave << ',' << binaryRestore << ',' << blobs.front().getSize() << '\n';
+
+        // What getStateInformation wrote before the binary format; still loaded for old sessions
+        const auto xmlSave = time ([] (LadderFilterBasicAudioProcessor& processor, juce::MemoryBlock& blob)
+        {
+            std::unique_ptr<juce::XmlElement> xml (processor.apvts.copyState().createXml());
+            juce::AudioProcessor::copyXmlToBinary (*xml, blob);
+        });
+
+        const auto xmlRestore = time (restore);
+        std::cout << "xml," << xmlSave << ',' << xmlRestore << ',' << blobs.front().getSize() << '\n';
+
+        // Both formats have to land on the same parameter values
+        for (int i = 0; i < numInstances; ++i)
+        {
+            if (processors[(size_t) i]->getParameterValues().cutoff != 100.0f + (float) i)
+            {
+                fail ("instance " + juce::String (i) + " did not restore its cutoff");
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    //==============================================================================
+    /** Footprint of many prepared instances, as in a large session: the object
+        itself plus everything it allocates, averaged over the instances. The
+        tanh tables are shared, so an instance made beforehand pays for them.
+
+        Measured with oversampling off and again at 8x linear phase, the largest
+        stage. Stages are only built once selected, so the first must come out
+        smaller; fails if it doesn't, where the C library can tell.
+    */
+    int runMemory (int numInstances)
+    {
+        constexpr int numChannels = 2, blockSize = 512;
+
+        const auto measure = [&] (Settings settings)
+        {
+            const auto before = heapBytesInUse();
+            std::vector<std::unique_ptr<LadderFilterBasicAudioProcessor>> processors;
+
+            for (int i = 0; i < numInstances; ++i)
+            {
+                processors.push_back (std::make_unique<LadderFilterBasicAudioProcessor>());
+                prepareProcessor (*processors.back(), numChannels, blockSize, settings);
+            }
+
+            const auto after = heapBytesInUse();
+            return before < 0 || after < 0 ? juce::int64 (-1) : (after - before) / numInstances;
+        };
+
+        // Built first, so the shared tables land in neither figure
+        LadderFilterBasicAudioProcessor first;
+        prepareProcessor (first, numChannels, blockSize, {});
+
+        const auto offBytes = measure ({ { "OVERSAMPLING", 0.0f } });
+        const auto oversampledBytes = measure ({ { "OVERSAMPLING", 3.0f }, { "OS_FILTER", 1.0f } });
+
+        std::cout << "instances," << numInstances << '\n'
+                  << "processor_object_bytes," << sizeof (LadderFilterBasicAudioProcessor) << '\n'
+                  << "ladder_engine_bytes," << sizeof (LadderEngine<float>) << '\n';
+
+        if (offBytes < 0 || oversampledBytes < 0)
+        {
+            std::cout << "heap_bytes_per_instance,unavailable\n";
+            return 0;
+        }
+
+        std::cout << "heap_bytes_per_instance," << offBytes << '\n'
+                  << "heap_mb_total," << (double) (offBytes * numInstances) / (1024.0 * 1024.0) << '\n'
+                  << "heap_bytes_per_instance_8x," << oversampledBytes << '\n';
+
+        if (offBytes < oversampledBytes)
+            return 0;
+
+        fail ("an instance without oversampling takes " + juce::String (offBytes) + " bytes, one at 8x "
+                + juce::String (oversampledBytes));
+        return 1;
+    }
+
+    //==============================================================================
+    /** Buffered versus memory mapped reading of one large file, with and without the filter.
+
+        The file is dropped from the page cache before every pass (Linux only), so
+        the figures are for a cold read; use a file larger than RAM elsewhere. The
+        mapped passes release the pages behind the read as they go, so on Linux
+        they leave the cache as empty as they found it, while the buffered passes
+        leave the file cached.
+    */
+    int runRead (const juce::File& file)
+    {
+        constexpr int blockSize = 4096;
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::cout << "method,filter,cold_cache,seconds,mb_per_sec,realtime_factor\n";
+
+        for (auto useMap : { false, true })
+        {
+            for (auto filter : { false, true })
+            {
+                const auto cold = MappedAudioReader::evictFromPageCache (file);
+
+                std::unique_ptr<juce::AudioFormatReader> reader;
+                juce::MemoryMappedAudioFormatReader* mapped = nullptr;
+
+                if (useMap)
+                {
+                    auto mappedReader = MappedAudioReader::open (file);
+                    mapped = mappedReader.get();
+                    reader = std::move (mappedReader);
+                }
+                else
+                {
+                    reader.reset (formatManager.createReaderFor (file));
+                }
+
+                if (reader == nullptr)
+                {
+                    fail ("Can't open " + file.getFullPathName() + (useMap ? " memory mapped" : ""));
+                    return 1;
+                }
+
+                const auto numChannels = (int) reader->numChannels;
+                LadderFilterBasicAudioProcessor processor;
+
+                if (filter)
+                    prepareProcessor (processor, numChannels, blockSize, { { "CUTOFF", 1000.0f }, { "RESONANCE", 0.5f } },
+                                      reader->sampleRate);
+
+                juce::AudioBuffer<float> buffer (numChannels, blockSize);
+                juce::MidiBuffer midi;
+                MappedAudioReader::Releaser releaser (mapped);
+                const auto start = Clock::now();
+
+                for (juce::int64 position = 0; position < reader->lengthInSamples; position += blockSize)
+                {
+                    const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, reader->lengthInSamples - position);
+                    reader->read (&buffer, 0, numSamples, position, true, true);
+
+                    releaser.release (position + numSamples);
+
+                    if (filter)
+                        processor.processBlock (buffer, midi);
+                }
+
+                const auto seconds = std::chrono::duration<double> (Clock::now() - start).count();
+
+                std::cout << (useMap ? "mapped," : "stream,") << (filter ? 1 : 0) << ',' << (cold ? 1 : 0) << ','
+                          << seconds << ','
+                          << (double) file.getSize() / (1024.0 * 1024.0) / seconds << ','
+                          << (double) reader->lengthInSamples / reader->sampleRate / seconds << '\n';
+            }
+        }
+
+        return 0;
+    }
+}
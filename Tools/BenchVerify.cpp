@@ -0,0 +1,411 @@
+/*
+  ==============================================================================
+
+    ladder_bench --verify: the correctness and performance gate run by ctest.
+
+  ==============================================================================
+*/
+
+#include "Bench.h"
+
+namespace Bench
+{
+    namespace
+    {
+        struct VerifyCase
+        {
+            int type;
+            int quality;
+            float cutoff;
+            float resonance;
+            float drive;
+        };
+
+        constexpr double verifySampleRate = 48000.0;
+        constexpr int verifyBlockSize = 512, verifyLength = 4096, goldenLength = 256;
+        constexpr const char* verifySignals[] = { "impulse", "sweep", "noise" };
+
+        std::vector<double> makeVerifySignal (int index)
+        {
+            std::vector<double> signal ((size_t) verifyLength, 0.0);
+
+            if (index == 0)
+            {
+                signal[0] = 0.5;
+            }
+            else if (index == 1)
+            {
+                // Exponential sine sweep, 20 Hz to 20 kHz
+                const auto rate = std::log (20000.0 / 20.0) / verifyLength;
+
+                for (int i = 0; i < verifyLength; ++i)
+                    signal[(size_t) i] = 0.5 * std::sin (juce::MathConstants<double>::twoPi * 20.0 / verifySampleRate
+                                                           * (std::exp (rate * i) - 1.0) / rate);
+            }
+            else
+            {
+                juce::Random random (0x1add3);
+
+                for (auto& s : signal)
+                    s = 0.25 * (random.nextDouble() * 2.0 - 1.0);
+            }
+
+            return signal;
+        }
+
+        /** The ladder as LadderEngine documents it, straight from the equations. */
+        std::vector<double> renderReferenceLadder (const VerifyCase& c, const std::vector<double>& input)
+        {
+            static constexpr double taps[6][5] { { 0, 0,  1,  0, 0 }, { 1, -2, 1,  0, 0 }, { 0, 0, -1,  1, 0 },
+                                                 { 0, 0,  0,  0, 1 }, { 1, -4, 6, -4, 1 }, { 0, 0,  1, -2, 1 } };
+
+            // Index order of filterTypes: LPF12, HPF12, BPF12, LPF24, HPF24, BPF24
+            const auto isHighPass = c.type == 1 || c.type == 4;
+            const auto comp = isHighPass ? 0.0 : 0.5;
+
+            const auto a1 = std::exp (-juce::MathConstants<double>::twoPi * c.cutoff / verifySampleRate);
+            const auto b0 = (1.0 - a1) * 0.76923076923;
+            const auto b1 = (1.0 - a1) * 0.23076923076;
+            const auto k = -4.0 * (0.1 + 0.9 * c.resonance);
+
+            const auto drive = (double) c.drive;
+            const auto gain = std::pow (drive, -2.642) * 0.6103 + 0.3903;
+            const auto drive2 = drive * 0.04 + 0.96;
+            const auto gain2 = std::pow (drive2, -2.642) * 0.6103 + 0.3903;
+
+            double s[5] {};
+            std::vector<double> output (input.size());
+
+            for (size_t n = 0; n < input.size(); ++n)
+            {
+                const auto dx = std::tanh (input[n] * drive) * gain;
+                const auto a = dx + (std::tanh (s[4] * drive2) * gain2 - dx * comp) * k;
+                const auto b = s[0] * b1 + s[1] * a1 + a * b0;
+                const auto cc = s[1] * b1 + s[2] * a1 + b * b0;
+                const auto d = s[2] * b1 + s[3] * a1 + cc * b0;
+                const auto e = s[3] * b1 + s[4] * a1 + d * b0;
+
+                s[0] = a; s[1] = b; s[2] = cc; s[3] = d; s[4] = e;
+
+                const auto* t = taps[c.type];
+                output[n] = 1.2 * (a * t[0] + b * t[1] + cc * t[2] + d * t[3] + e * t[4]);
+            }
+
+            return output;
+        }
+
+        void prepareForVerify (LadderFilterBasicAudioProcessor& processor, const VerifyCase& c)
+        {
+            setChannelLayout (processor, 2);
+            setParameter (processor.apvts, "TYPE", (float) c.type);
+            setParameter (processor.apvts, "QUALITY", (float) c.quality);
+            setParameter (processor.apvts, "CUTOFF", c.cutoff);
+            setParameter (processor.apvts, "RESONANCE", c.resonance);
+            setParameter (processor.apvts, "DRIVE", c.drive);
+            processor.setRateAndBufferSizeDetails (verifySampleRate, verifyBlockSize);
+        }
+
+        /** Renders a signal into both channels from a freshly reset ladder. */
+        juce::AudioBuffer<float> renderThroughProcessor (LadderFilterBasicAudioProcessor& processor, const std::vector<double>& input)
+        {
+            processor.prepareToPlay (verifySampleRate, verifyBlockSize);
+
+            juce::AudioBuffer<float> output (2, verifyLength);
+            juce::MidiBuffer midi;
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < verifyLength; ++i)
+                    output.setSample (ch, i, (float) input[(size_t) i]);
+
+            for (int start = 0; start < verifyLength; start += verifyBlockSize)
+            {
+                juce::AudioBuffer<float> block (output.getArrayOfWritePointers(), 2, start, verifyBlockSize);
+                processor.processBlock (block, midi);
+            }
+
+            return output;
+        }
+
+        /** Noise through a bare ladder on the given channel layout, with the cutoff swept and a
+            mode and saturation change part way, so both the steady and the fading kernels run and
+            the automatic layout moves its state across when the kernel calls for the other one.
+            Five channels fill one register of float lanes and leave a partial one. */
+        template <typename SampleType>
+        juce::AudioBuffer<SampleType> renderLayout (int type, int quality, typename LadderEngine<SampleType>::Layout layout)
+        {
+            constexpr int numChannels = 5;
+
+            LadderEngine<SampleType> ladder;
+            ladder.prepare ({ verifySampleRate, (juce::uint32) verifyBlockSize, (juce::uint32) numChannels });
+            ladder.setLayout (layout);
+            ladder.setMode ((juce::dsp::LadderFilterMode) ((type + 1) % 6));
+            ladder.setSaturation ((Saturation::Kernel) ((quality + 1) % 3));
+            ladder.setResonance (SampleType (0.75));
+            ladder.setDrive (SampleType (4));
+            ladder.reset();
+
+            juce::AudioBuffer<SampleType> buffer (numChannels, verifyLength);
+            juce::Random random (0x51d);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < verifyLength; ++i)
+                    buffer.setSample (ch, i, SampleType (0.25 * (random.nextDouble() * 2.0 - 1.0)));
+
+            for (int start = 0; start < verifyLength; start += verifyBlockSize)
+            {
+                if (start == 2 * verifyBlockSize)
+                {
+                    ladder.setMode ((juce::dsp::LadderFilterMode) type);
+                    ladder.setSaturation ((Saturation::Kernel) quality);
+                }
+
+                ladder.setCutoffFrequencyHz (SampleType (200.0 * std::pow (50.0, (double) start / verifyLength)));
+
+                auto block = juce::dsp::AudioBlock<SampleType> (buffer).getSubBlock ((size_t) start, (size_t) verifyBlockSize);
+                ladder.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+            }
+
+            return buffer;
+        }
+    }
+
+    //==============================================================================
+    /** Correctness and performance gate, for CI and before merging DSP changes.
+
+        Renders an impulse, a log sweep and noise through every mode over a grid of
+        cutoff, resonance and drive, at each saturation quality, and checks:
+
+          - against a plain double precision model of the ladder (per sample
+            coefficients, std::tanh), to a tolerance per quality set by its tanh error:
+            a tight one near unit drive and moderate resonance, where the kernels
+            work close to zero, and a looser one where drive or resonance push the
+            signal into the knee and the clamp
+          - against golden renders from an earlier build, if --golden is given
+          - the SIMD and the automatic channel layouts against the scalar one, which
+            must agree to rounding for every mode and kernel, across a kernel change
+            that moves the automatic layout's state from one to the other
+          - with --perf, the cost of each mode and quality: against the figures in
+            --budgets plus 25%, recorded on the same machine, or without them
+            against twice the median cost of all the cells in this run, which
+            catches one mode or kernel falling off its fast path on any machine
+
+        --record writes the golden file and the budgets file from this build instead
+        of checking them. Returns 1 if any check fails.
+    */
+    int runVerify (const juce::ArgumentList& args)
+    {
+        // lookupTable, pade, polynomial; hot cells have drive above 2 or resonance above 0.5
+        static constexpr double toleranceDb[]    { -50.0, -90.0, -45.0 };
+        static constexpr double hotToleranceDb[] { -40.0, -70.0, -25.0 };
+        static constexpr double goldenToleranceDb = -60.0;
+        static constexpr double layoutToleranceDb = -100.0;
+        static constexpr double budgetSlack = 1.25;
+        static constexpr double maxCostOverMedian = 2.0;
+
+        const auto record = args.containsOption ("--record");
+        const auto goldenFile = args.containsOption ("--golden") ? args.getFileForOption ("--golden") : juce::File();
+        const auto budgetsFile = args.containsOption ("--budgets") ? args.getFileForOption ("--budgets") : juce::File();
+        const auto measurePerformance = args.containsOption ("--perf") || (record && budgetsFile != juce::File());
+
+        std::vector<float> golden;
+        const auto checkGolden = goldenFile != juce::File() && ! record;
+
+        if (checkGolden)
+        {
+            juce::MemoryBlock data;
+
+            if (! goldenFile.loadFileAsData (data))
+            {
+                std::cerr << "Can't read " << goldenFile.getFullPathName() << '\n';
+                return 1;
+            }
+
+            golden.resize (data.getSize() / sizeof (float));
+            data.copyTo (golden.data(), 0, golden.size() * sizeof (float));
+        }
+
+        std::vector<double> signals[std::size (verifySignals)];
+
+        for (size_t i = 0; i < std::size (verifySignals); ++i)
+            signals[i] = makeVerifySignal ((int) i);
+
+        LadderFilterBasicAudioProcessor names;
+        juce::MemoryOutputStream goldenOut;
+        size_t goldenOffset = 0;
+        int numChecks = 0, numFailures = 0;
+
+        const auto failCase = [&] (const VerifyCase& c, const char* what, double value, double limit)
+        {
+            ++numFailures;
+            std::cout << "FAIL," << names.filterTypes[c.type] << ",quality " << c.quality << ",cutoff " << c.cutoff
+                      << ",resonance " << c.resonance << ",drive " << c.drive << ',' << what << ',' << value << ',' << limit << '\n';
+        };
+
+        // Golden renders are kept for the default quality only, channel 0, first goldenLength samples
+        for (int quality = 0; quality < 3; ++quality)
+            for (int type = 0; type < 6; ++type)
+                for (auto cutoff : { 100.0f, 1000.0f, 8000.0f })
+                    for (auto resonance : { 0.0f, 0.4f, 0.75f })
+                        for (auto drive : { 1.0f, 4.0f, 10.0f })
+                        {
+                            const VerifyCase c { type, quality, cutoff, resonance, drive };
+                            LadderFilterBasicAudioProcessor processor;
+                            prepareForVerify (processor, c);
+
+                            for (size_t signal = 0; signal < std::size (verifySignals); ++signal)
+                            {
+                                const auto output = renderThroughProcessor (processor, signals[signal]);
+                                const auto reference = renderReferenceLadder (c, signals[signal]);
+
+                                for (int ch = 0; ch < 2; ++ch)
+                                {
+                                    ++numChecks;
+                                    const auto db = errorDb (output.getReadPointer (ch), reference.data(), verifyLength);
+
+                                    const auto limit = (drive > 2.0f || resonance > 0.5f) ? hotToleranceDb[quality]
+                                                                                           : toleranceDb[quality];
+
+                                    if (db > limit)
+                                        failCase (c, verifySignals[signal], db, limit);
+                                }
+
+                                if (quality != 0)
+                                    continue;
+
+                                if (record)
+                                {
+                                    goldenOut.write (output.getReadPointer (0), goldenLength * sizeof (float));
+                                }
+                                else if (checkGolden)
+                                {
+                                    ++numChecks;
+
+                                    if (goldenOffset + goldenLength > golden.size())
+                                    {
+                                        failCase (c, "golden file too short", (double) golden.size(), (double) (goldenOffset + goldenLength));
+                                        continue;
+                                    }
+
+                                    const auto db = errorDb (output.getReadPointer (0), golden.data() + goldenOffset, goldenLength);
+
+                                    if (db > goldenToleranceDb)
+                                        failCase (c, "golden", db, goldenToleranceDb);
+                                }
+
+                                goldenOffset += goldenLength;
+                            }
+                        }
+
+        // Both channel layouts on identical input, in both precisions
+        for (int quality = 0; quality < 3; ++quality)
+        {
+            for (int type = 0; type < 6; ++type)
+            {
+                const VerifyCase c { type, quality, 200.0f, 0.75f, 4.0f };
+
+                const auto compare = [&] (const auto& vectorised, const auto& scalar, const char* what)
+                {
+                    for (int ch = 0; ch < vectorised.getNumChannels(); ++ch)
+                    {
+                        ++numChecks;
+                        const auto db = errorDb (vectorised.getReadPointer (ch), scalar.getReadPointer (ch), verifyLength);
+
+                        if (db > layoutToleranceDb)
+                            failCase (c, what, db, layoutToleranceDb);
+                    }
+                };
+
+                using FloatLayout = LadderEngine<float>::Layout;
+                using DoubleLayout = LadderEngine<double>::Layout;
+
+                const auto scalarFloat = renderLayout<float> (type, quality, FloatLayout::scalar);
+                const auto scalarDouble = renderLayout<double> (type, quality, DoubleLayout::scalar);
+
+                compare (renderLayout<float> (type, quality, FloatLayout::vectorised), scalarFloat, "simd float");
+                compare (renderLayout<double> (type, quality, DoubleLayout::vectorised), scalarDouble, "simd double");
+                compare (renderLayout<float> (type, quality, FloatLayout::automatic), scalarFloat, "automatic float");
+                compare (renderLayout<double> (type, quality, DoubleLayout::automatic), scalarDouble, "automatic double");
+            }
+        }
+
+        // Performance, only when asked for: timings depend on the machine and what else it runs
+        if (measurePerformance)
+        {
+            juce::StringPairArray budgets;
+
+            if (budgetsFile.existsAsFile() && ! record)
+            {
+                juce::StringArray lines;
+                lines.addLines (budgetsFile.loadFileAsString());
+
+                for (auto& line : lines)
+                    if (line.containsChar (','))
+                        budgets.set (line.upToLastOccurrenceOf (",", false, false), line.fromLastOccurrenceOf (",", false, false));
+            }
+
+            // One second of noise per mode and quality, at a mid setting
+            juce::String budgetsOut;
+            juce::AudioBuffer<float> noise (2, verifyBlockSize);
+            fillWithNoise (noise);
+
+            std::vector<std::pair<VerifyCase, double>> costs;
+
+            for (int quality = 0; quality < 3; ++quality)
+            {
+                for (int type = 0; type < 6; ++type)
+                {
+                    const VerifyCase c { type, quality, 1000.0f, 0.5f, 2.0f };
+                    LadderFilterBasicAudioProcessor processor;
+                    prepareForVerify (processor, c);
+                    processor.prepareToPlay (verifySampleRate, verifyBlockSize);
+
+                    const auto numBlocks = (int) verifySampleRate / verifyBlockSize;
+                    juce::AudioBuffer<float> buffer (2, verifyBlockSize);
+                    auto fastest = Clock::duration::max();
+
+                    // Best of three passes, so a busy machine doesn't fail the run
+                    for (int pass = 0; pass < 3; ++pass)
+                        fastest = std::min (fastest, processBlocks (processor, buffer, numBlocks,
+                                                                    [&] (int, auto& b, auto&) { b.makeCopyOf (noise, true); }));
+
+                    const auto ns = nsPerSample (fastest, numBlocks, verifyBlockSize, 2);
+                    const auto key = juce::String (names.filterTypes[type]) + "," + juce::String (quality);
+
+                    budgetsOut << key << ',' << juce::String (ns, 3) << '\n';
+                    std::cout << "perf," << key << ',' << ns << '\n';
+                    costs.push_back ({ c, ns });
+                }
+            }
+
+            if (record)
+            {
+                if (budgetsFile != juce::File() && ! budgetsFile.replaceWithText (budgetsOut))
+                    return 1;
+            }
+            else
+            {
+                // Without recorded budgets, each cell is held against the median cell of this run
+                auto sorted = costs;
+                std::sort (sorted.begin(), sorted.end(), [] (const auto& a, const auto& b) { return a.second < b.second; });
+                const auto medianNs = sorted[sorted.size() / 2].second;
+
+                for (auto& [c, ns] : costs)
+                {
+                    const auto key = juce::String (names.filterTypes[c.type]) + "," + juce::String (c.quality);
+                    const auto budget = budgets.containsKey (key) ? budgets[key].getDoubleValue() * budgetSlack
+                                                                  : medianNs * maxCostOverMedian;
+                    ++numChecks;
+
+                    if (ns > budget)
+                        failCase (c, "ns_per_sample", ns, budget);
+                }
+            }
+        }
+
+        if (record && goldenFile != juce::File() && ! goldenFile.replaceWithData (goldenOut.getData(), goldenOut.getDataSize()))
+            return 1;
+
+        std::cout << "checks," << numChecks << "\nfailures," << numFailures << '\n';
+        return numFailures > 0 ? 1 : 0;
+    }
+}
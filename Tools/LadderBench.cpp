@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    Offline render benchmark for LadderFilterBasicAudioProcessor. Drives
+    prepareToPlay/processBlock over synthetic noise for a matrix of filter
+    types, sample rates, channel counts and block sizes and writes one CSV
+    row per configuration:
+
+        type,quality,sample_rate,channels,block_size,ns_per_sample,samples_per_sec,realtime_factor,worst_block_us
+
+    ns_per_sample and samples_per_sec count single channel samples, so runs
+    with different channel counts stay comparable. The other modes, in the
+    Bench*.cpp files beside this one, print their own CSV and exit with 1
+    when one of their checks fails.
+
+    Usage: ladder_bench [--quick] [--seconds <s>] [--quality <0-2>] [--output <file.csv>]
+           ladder_bench --params
+           ladder_bench --control-rate
+           ladder_bench --kernels
+           ladder_bench --layouts
+           ladder_bench --silence
+           ladder_bench --instrumentation
+           ladder_bench --precision
+           ladder_bench --voices
+           ladder_bench --sidechain
+           ladder_bench --state
+           ladder_bench --programs
+           ladder_bench --memory [--instances <n>]
+           ladder_bench --denormals
+           ladder_bench --verify [--perf] [--golden <file>] [--budgets <file.csv>] [--record]
+           ladder_bench --read <file.wav|file.aif>
+
+  ==============================================================================
+*/
+
+#include "Bench.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--params"))
+        return Bench::runParameterLookup();
+
+    if (args.containsOption ("--control-rate"))
+        return Bench::runControlRate();
+
+    if (args.containsOption ("--kernels"))
+        return Bench::runKernels();
+
+    if (args.containsOption ("--layouts"))
+        return Bench::runLayouts();
+
+    if (args.containsOption ("--silence"))
+        return Bench::runSilence();
+
+    if (args.containsOption ("--instrumentation"))
+        return Bench::runInstrumentation();
+
+    if (args.containsOption ("--precision"))
+        return Bench::runPrecision();
+
+    if (args.containsOption ("--voices"))
+        return Bench::runVoices();
+
+    if (args.containsOption ("--sidechain"))
+        return Bench::runSidechain();
+
+    if (args.containsOption ("--state"))
+        return Bench::runState();
+
+    if (args.containsOption ("--programs"))
+        return Bench::runPrograms();
+
+    if (args.containsOption ("--memory"))
+        return Bench::runMemory (args.containsOption ("--instances") ? juce::jmax (1, args.getValueForOption ("--instances").getIntValue()) : 500);
+
+    if (args.containsOption ("--denormals"))
+        return Bench::runDenormals();
+
+    if (args.containsOption ("--verify"))
+        return Bench::runVerify (args);
+
+    if (args.containsOption ("--read"))
+        return Bench::runRead (args.getExistingFileForOption ("--read"));
+
+    return Bench::runMatrix (args);
+}
@@ -0,0 +1,364 @@
+/*
+  ==============================================================================
+
+    Batch renders a directory tree of WAV, FLAC and AIFF files through
+    LadderFilterBasicAudioProcessor with fixed parameter settings, writing
+    the results with the same relative paths and formats under the output
+    directory.
+
+    Every worker thread owns one processor and one chunk buffer, and files
+    are streamed through in chunks of --chunk samples, so memory does not
+    grow with file length. Files are dealt out round robin to per-worker
+    queues; a worker that runs out steals from the back of the others'.
+    Output is aligned with the input by skipping the oversampling latency.
+
+    WAV and AIFF sources are memory mapped (see MappedAudioReader.h) unless
+    --stream is given, which reads them through the usual buffered readers.
+
+    Usage: ladder_render --input <dir> --output <dir>
+                         [--cutoff <Hz>] [--resonance <0-0.75>] [--drive <1-10>]
+                         [--type <0-5>] [--quality <0-2>] [--oversampling <0-3>]
+                         [--threads <n>] [--chunk <samples>] [--with-tail] [--stream]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "MappedAudioReader.h"
+
+#include <deque>
+#include <iostream>
+
+namespace
+{
+    struct RenderSettings
+    {
+        float cutoff = 2000.0f;
+        float resonance = 0.0f;
+        float drive = 1.0f;
+        int type = 0;
+        int quality = 0;
+        int oversampling = 0;
+        int chunkSize = 4096;
+        bool withTail = false;
+        bool streamInput = false;
+    };
+
+    struct Job
+    {
+        juce::File source, destination;
+    };
+
+    //==============================================================================
+    /** One worker's jobs. The owner takes from the front, thieves from the back. */
+    class JobQueue
+    {
+    public:
+        void add (const Job& job)
+        {
+            const juce::SpinLock::ScopedLockType lock (mutex);
+            jobs.push_back (job);
+        }
+
+        bool takeFront (Job& job)
+        {
+            const juce::SpinLock::ScopedLockType lock (mutex);
+
+            if (jobs.empty())
+                return false;
+
+            job = jobs.front();
+            jobs.pop_front();
+            return true;
+        }
+
+        bool stealBack (Job& job)
+        {
+            const juce::SpinLock::ScopedLockType lock (mutex);
+
+            if (jobs.empty())
+                return false;
+
+            job = jobs.back();
+            jobs.pop_back();
+            return true;
+        }
+
+    private:
+        juce::SpinLock mutex;
+        std::deque<Job> jobs;
+    };
+
+    //==============================================================================
+    void setParameter (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+    {
+        auto* parameter = apvts.getParameter (parameterID);
+        jassert (parameter != nullptr);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    bool setChannelLayout (juce::AudioProcessor& processor, int numChannels)
+    {
+        auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+        if (channelSet.isDisabled())
+            channelSet = juce::AudioChannelSet::discreteChannels (numChannels);
+
+        // Start from the current layout so any further buses (the sidechain) are left as they are
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference (0) = channelSet;
+        layout.outputBuses.getReference (0) = channelSet;
+
+        return processor.setBusesLayout (layout);
+    }
+
+    //==============================================================================
+    class RenderWorker  : public juce::Thread
+    {
+    public:
+        RenderWorker (int workerIndex, juce::OwnedArray<JobQueue>& allQueues, const RenderSettings& s)
+            : juce::Thread ("Render worker " + juce::String (workerIndex)),
+              index (workerIndex), queues (allQueues), settings (s)
+        {
+            formatManager.registerBasicFormats();
+
+            setParameter (processor.apvts, "CUTOFF", settings.cutoff);
+            setParameter (processor.apvts, "RESONANCE", settings.resonance);
+            setParameter (processor.apvts, "DRIVE", settings.drive);
+            setParameter (processor.apvts, "TYPE", (float) settings.type);
+            setParameter (processor.apvts, "QUALITY", (float) settings.quality);
+            setParameter (processor.apvts, "OVERSAMPLING", (float) settings.oversampling);
+            processor.setNonRealtime (true);
+        }
+
+        void run() override
+        {
+            Job job;
+
+            while (! threadShouldExit() && nextJob (job))
+            {
+                juce::String error;
+
+                if (render (job, error))
+                    ++filesDone;
+                else
+                    errors.add (job.source.getFullPathName() + ": " + error);
+            }
+        }
+
+        int filesDone = 0;
+        double secondsRendered = 0.0;
+        juce::StringArray errors;
+
+    private:
+        bool nextJob (Job& job)
+        {
+            if (queues[index]->takeFront (job))
+                return true;
+
+            for (int i = 1; i < queues.size(); ++i)
+                if (queues[(index + i) % queues.size()]->stealBack (job))
+                    return true;
+
+            return false;
+        }
+
+        bool render (const Job& job, juce::String& error)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            juce::MemoryMappedAudioFormatReader* mapped = nullptr;
+
+            if (! settings.streamInput)
+            {
+                auto mappedReader = MappedAudioReader::open (job.source);
+                mapped = mappedReader.get();
+                reader = std::move (mappedReader);
+            }
+
+            if (reader == nullptr)
+                reader.reset (formatManager.createReaderFor (job.source));
+
+            if (reader == nullptr)
+                return (error = "unreadable"), false;
+
+            auto* format = formatManager.findFormatForFileExtension (job.destination.getFileExtension());
+            const auto numChannels = (int) reader->numChannels;
+
+            if (format == nullptr || ! setChannelLayout (processor, numChannels))
+                return (error = "unsupported format or channel count"), false;
+
+            job.destination.getParentDirectory().createDirectory();
+            job.destination.deleteFile();
+
+            auto bitDepth = (int) reader->bitsPerSample;
+            const auto possibleDepths = format->getPossibleBitDepths();
+
+            if (! possibleDepths.contains (bitDepth))
+                bitDepth = possibleDepths.getLast();
+
+            std::unique_ptr<juce::AudioFormatWriter> writer;
+
+            if (auto stream = job.destination.createOutputStream())
+            {
+                writer.reset (format->createWriterFor (stream.get(), reader->sampleRate, (unsigned int) numChannels,
+                                                       bitDepth, reader->metadataValues, 0));
+
+                if (writer != nullptr)
+                    stream.release();   // the writer owns it now
+            }
+
+            if (writer == nullptr)
+                return (error = "cannot write " + job.destination.getFullPathName()), false;
+
+            const auto chunkSize = settings.chunkSize;
+            processor.setRateAndBufferSizeDetails (reader->sampleRate, chunkSize);
+            processor.prepareToPlay (reader->sampleRate, chunkSize);
+            buffer.setSize (numChannels, chunkSize, false, false, true);
+
+            auto samplesToSkip = (juce::int64) processor.getLatencySamples();
+            auto samplesToWrite = reader->lengthInSamples;
+
+            if (settings.withTail)
+                samplesToWrite += (juce::int64) std::ceil (processor.getTailLengthSeconds() * reader->sampleRate);
+
+            juce::int64 readPosition = 0;
+            MappedAudioReader::Releaser releaser (mapped);
+
+            while (samplesToWrite > 0)
+            {
+                buffer.clear();
+                const auto numToRead = (int) juce::jmin ((juce::int64) chunkSize, reader->lengthInSamples - readPosition);
+
+                if (numToRead > 0 && ! reader->read (&buffer, 0, numToRead, readPosition, true, true))
+                    return (error = "read failed"), false;
+
+                readPosition += chunkSize;
+
+                releaser.release (readPosition);
+
+                processor.processBlock (buffer, midi);
+
+                const auto skip = (int) juce::jmin ((juce::int64) chunkSize, samplesToSkip);
+                const auto numToWrite = (int) juce::jmin ((juce::int64) (chunkSize - skip), samplesToWrite);
+                samplesToSkip -= skip;
+
+                if (numToWrite > 0)
+                {
+                    if (! writer->writeFromAudioSampleBuffer (buffer, skip, numToWrite))
+                        return (error = "write failed"), false;
+
+                    samplesToWrite -= numToWrite;
+                }
+            }
+
+            processor.releaseResources();
+            secondsRendered += (double) reader->lengthInSamples / reader->sampleRate;
+            return true;
+        }
+
+        const int index;
+        juce::OwnedArray<JobQueue>& queues;
+        const RenderSettings settings;
+
+        juce::AudioFormatManager formatManager;
+        LadderFilterBasicAudioProcessor processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+
+    //==============================================================================
+    int printUsage()
+    {
+        std::cerr << "Usage: ladder_render --input <dir> --output <dir> [--cutoff <Hz>] [--resonance <0-0.75>]\n"
+                     "                     [--drive <1-10>] [--type <0-5>] [--quality <0-2>] [--oversampling <0-3>]\n"
+                     "                     [--threads <n>] [--chunk <samples>] [--with-tail] [--stream]\n";
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--input") || ! args.containsOption ("--output"))
+        return printUsage();
+
+    const auto inputDir = args.getExistingFolderForOption ("--input");
+    const auto outputDir = args.getFileForOption ("--output");
+
+    const auto option = [&args] (const char* name, double fallback)
+    {
+        return args.containsOption (name) ? args.getValueForOption (name).getDoubleValue() : fallback;
+    };
+
+    RenderSettings settings;
+    settings.cutoff       = (float) option ("--cutoff", settings.cutoff);
+    settings.resonance    = (float) option ("--resonance", settings.resonance);
+    settings.drive        = (float) option ("--drive", settings.drive);
+    settings.type         = (int) option ("--type", settings.type);
+    settings.quality      = (int) option ("--quality", settings.quality);
+    settings.oversampling = (int) option ("--oversampling", settings.oversampling);
+    settings.chunkSize    = juce::jmax (16, (int) option ("--chunk", settings.chunkSize));
+    settings.withTail     = args.containsOption ("--with-tail");
+    settings.streamInput  = args.containsOption ("--stream");
+
+    const auto numThreads = juce::jmax (1, (int) option ("--threads", juce::SystemStats::getNumCpus()));
+
+    const auto files = inputDir.findChildFiles (juce::File::findFiles, true, "*.wav;*.flac;*.aif;*.aiff");
+
+    if (files.isEmpty())
+    {
+        std::cerr << "No audio files found in " << inputDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // Deal the files out round robin; stealing evens out whatever the sizes turn out to be
+    juce::OwnedArray<JobQueue> queues;
+
+    for (int i = 0; i < numThreads; ++i)
+        queues.add (new JobQueue());
+
+    for (int i = 0; i < files.size(); ++i)
+        queues[i % numThreads]->add ({ files[i], outputDir.getChildFile (files[i].getRelativePathFrom (inputDir)) });
+
+    juce::OwnedArray<RenderWorker> workers;
+
+    for (int i = 0; i < numThreads; ++i)
+        workers.add (new RenderWorker (i, queues, settings));
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto* w : workers)
+        w->startThread();
+
+    for (auto* w : workers)
+        w->waitForThreadToExit (-1);
+
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    int filesDone = 0;
+    double audioSeconds = 0.0;
+    juce::StringArray errors;
+
+    for (auto* w : workers)
+    {
+        filesDone += w->filesDone;
+        audioSeconds += w->secondsRendered;
+        errors.addArray (w->errors);
+    }
+
+    for (auto& e : errors)
+        std::cerr << e << '\n';
+
+    std::cout << "files," << filesDone << '\n'
+              << "failed," << errors.size() << '\n'
+              << "threads," << numThreads << '\n'
+              << "wall_seconds," << seconds << '\n'
+              << "files_per_sec," << filesDone / seconds << '\n'
+              << "realtime_factor," << audioSeconds / seconds << '\n';
+
+    return errors.isEmpty() ? 0 : 1;
+}
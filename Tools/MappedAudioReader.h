@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    Memory mapped input for the offline tools. WAV and AIFF files are opened
+    through juce::MemoryMappedAudioFormatReader, so reading a chunk is a
+    single conversion from the page cache straight into the buffer that
+    processBlock works on, with no read() syscalls or staging buffers. The
+    kernel is told the mapping will be read front to back. As the render moves
+    on, a Releaser unmaps the pages behind the read position, and on Linux
+    also drops them from the page cache with posix_fadvise (unmapping alone
+    only leaves them cached but unused), so a file far larger than RAM streams
+    through without filling the cache. Elsewhere only the process's own
+    footprint stays bounded.
+
+    The mapping is read only, so one copy into a writable buffer remains;
+    processBlock filters in place.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+namespace MappedAudioReader
+{
+    namespace detail
+    {
+        /** Gets at the reader's protected mapping without changing how the format creates it. */
+        struct Access  : juce::MemoryMappedAudioFormatReader
+        {
+            static juce::MemoryMappedFile* getMap (juce::MemoryMappedAudioFormatReader& reader)
+            {
+                return (reader.*(&Access::map)).get();
+            }
+
+            static juce::int64 getFilePosition (juce::MemoryMappedAudioFormatReader& reader, juce::int64 sample)
+            {
+                return reader.*(&Access::dataChunkStart) + sample * reader.*(&Access::bytesPerFrame);
+            }
+        };
+
+        inline void advise (void* start, size_t numBytes, int advice)
+        {
+           #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+            if (numBytes > 0)
+                ::madvise (start, numBytes, advice);
+           #else
+            juce::ignoreUnused (start, numBytes, advice);
+           #endif
+        }
+    }
+
+    //==============================================================================
+    /** Maps the whole of a WAV or AIFF file for sequential reading.
+        Returns nullptr for other formats, or if the file can't be mapped.
+    */
+    inline std::unique_ptr<juce::MemoryMappedAudioFormatReader> open (const juce::File& file)
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+
+        if (file.hasFileExtension ("wav"))
+            reader.reset (juce::WavAudioFormat().createMemoryMappedReader (file));
+        else if (file.hasFileExtension ("aif;aiff"))
+            reader.reset (juce::AiffAudioFormat().createMemoryMappedReader (file));
+
+        if (reader == nullptr || ! reader->mapEntireFile())
+            return {};
+
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        if (auto* map = detail::Access::getMap (*reader))
+            detail::advise (map->getData(), map->getSize(), MADV_SEQUENTIAL);
+       #endif
+
+        return reader;
+    }
+
+    //==============================================================================
+    /** Hands back the pages of a mapped reader that the read has moved past: they
+        are unmapped with MADV_DONTNEED, and on Linux evicted from the page cache
+        with POSIX_FADV_DONTNEED on the file, which only drops pages nothing maps.
+        Works in steps of releaseStep bytes, so the syscalls stay rare. A null
+        reader makes release() a no-op, for callers that fell back to streaming.
+    */
+    class Releaser
+    {
+    public:
+        explicit Releaser (juce::MemoryMappedAudioFormatReader* readerToUse)
+            : reader (readerToUse)
+        {
+           #if JUCE_LINUX
+            if (reader != nullptr)
+                fd = ::open (reader->getFile().getFullPathName().toRawUTF8(), O_RDONLY);
+           #endif
+        }
+
+        ~Releaser()
+        {
+           #if JUCE_LINUX
+            if (fd >= 0)
+                ::close (fd);
+           #endif
+        }
+
+        /** Samples before position won't be read again. */
+        void release (juce::int64 position)
+        {
+           #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+            auto* map = reader != nullptr ? detail::Access::getMap (*reader) : nullptr;
+
+            if (map == nullptr)
+                return;
+
+            // The mapping starts on a page boundary, and releaseStep is a whole number of pages
+            const auto consumed = detail::Access::getFilePosition (*reader, position) - map->getRange().getStart();
+            const auto numBytes = juce::jlimit ((juce::int64) 0, (juce::int64) map->getSize(), consumed - consumed % releaseStep);
+
+            if (numBytes <= released)
+                return;
+
+            detail::advise (static_cast<char*> (map->getData()) + released, (size_t) (numBytes - released), MADV_DONTNEED);
+
+           #if JUCE_LINUX
+            if (fd >= 0)
+                ::posix_fadvise (fd, (off_t) (map->getRange().getStart() + released), (off_t) (numBytes - released), POSIX_FADV_DONTNEED);
+           #endif
+
+            released = numBytes;
+           #else
+            juce::ignoreUnused (position);
+           #endif
+        }
+
+    private:
+        static constexpr juce::int64 releaseStep = 4 * 1024 * 1024;
+
+        juce::MemoryMappedAudioFormatReader* reader;
+        juce::int64 released = 0;
+        int fd = -1;
+
+        JUCE_DECLARE_NON_COPYABLE (Releaser)
+    };
+
+    /** Best effort: drops a file's clean pages from the page cache so the next read comes from disk. */
+    inline bool evictFromPageCache (const juce::File& file)
+    {
+       #if JUCE_LINUX
+        const auto fd = ::open (file.getFullPathName().toRawUTF8(), O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        const auto result = ::posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close (fd);
+        return result == 0;
+       #else
+        juce::ignoreUnused (file);
+        return false;
+       #endif
+    }
+}